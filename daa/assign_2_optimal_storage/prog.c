@@ -5,100 +5,341 @@
  */
 
 #include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
 
-#define MAX 50          // Max array (haystack) size limit - any array
+#define NAME_LIMIT 256  // Max length of a program name, terminator included
 
 
 /*
  * To store the program with its identity
  *
  * @structure Program
- * @attribute char[] name
+ * @attribute int name - Offset of name in string pool
  * @attribute int length
+ * @attribute int frequency - Accesses of program (1 unless weighted)
  * @identifier Program
  *
  */
-typedef struct Program {        // A structure for Program - name, length
-    char name[MAX];
+typedef struct Program {        // A structure for Program - name, length, frequency
+    int name;
     int length;
+    int frequency;
 } Program;
 
 
 /*
- * Merging of Haystack elements - Merge Sort
+ * Interned strings - every distinct name is stored once, back to back, found
+ * again through an open addressing hash table of offsets
  *
- * @function void merge
- * @param Program[] programs - Haystack of Programs for sorting
- * @param int low - Lower bound index
- * @param int mid - Center pivot index
- * @param int high - Upper bound index
+ * @structure StringPool
+ * @attribute char[] chars - Names, null terminated, back to back
+ * @attribute int used - Bytes of chars in use
+ * @attribute int capacity - Bytes allocated for chars
+ * @attribute int[] slots - Hash table, offset of name + 1 (0 - empty slot)
+ * @attribute int slotCount - Size of hash table (power of 2)
+ * @attribute int count - Distinct names
+ * @identifier StringPool
  *
  */
-void merge(Program programs[MAX], int low, int mid, int high) {
-    int l1, l2, i;
-    Program bkp_programs[MAX];
-
-    for (l1 = low, l2 = mid + 1, i = low; l1 <= mid && l2 <= high; i++) {
-        if (programs[l1].length <= programs[l2].length)
-            bkp_programs[i] = programs[l1++];
-        else
-            bkp_programs[i] = programs[l2++];
+typedef struct StringPool {
+    char *chars;
+    int used, capacity;
+    int *slots;
+    int slotCount, count;
+} StringPool;
+
+
+/*
+ * Tape Storage - program indices of every tape in one contiguous array,
+ * tape after tape
+ *
+ * @structure Storage
+ * @attribute int tapeCount - No. of tapes
+ * @attribute int[] start - Tape t holds programs[start[t]] to programs[start[t + 1] - 1] (tapeCount + 1 offsets)
+ * @attribute int[] programs - Indices of programs in haystack
+ * @identifier Storage
+ *
+ */
+typedef struct Storage {
+    int tapeCount;
+    int *start;
+    int *programs;
+} Storage;
+
+
+/*
+ * Hash of a name - FNV-1a
+ *
+ * @function unsigned hashName
+ * @param const char *name
+ * @return unsigned hash
+ *
+ */
+
+unsigned hashName(const char *name) {
+    unsigned hash = 2166136261u;
+
+    while (*name)
+        hash = (hash ^ (unsigned char) *name++) * 16777619u;
+
+    return hash;
+}
+
+/*
+ * Set up an empty string pool
+ *
+ * @function void initPool
+ * @param StringPool *pool
+ *
+ */
+
+void initPool(StringPool *pool) {
+    pool->used = 0;
+    pool->capacity = 1024;
+    pool->chars = (char *) malloc(pool->capacity);
+    pool->slotCount = 64;
+    pool->slots = (int *) calloc(pool->slotCount, sizeof(int));
+    pool->count = 0;
+}
+
+/*
+ * Intern a name - store it unless an equal one is already stored
+ *
+ * @function int intern
+ * @param StringPool *pool
+ * @param const char *name
+ * @return int offset - Offset of name in pool
+ *
+ */
+
+int intern(StringPool *pool, const char *name) {
+    unsigned mask = pool->slotCount - 1, slot = hashName(name) & mask;
+    int length = strlen(name) + 1;
+
+    while (pool->slots[slot] != 0) {                // Probe till name or an empty slot is found
+        if (strcmp(pool->chars + pool->slots[slot] - 1, name) == 0)
+            return pool->slots[slot] - 1;
+        slot = (slot + 1) & mask;
     }
 
-    while (l1 <= mid)
-        bkp_programs[i++] = programs[l1++];
+    if (pool->used + length > pool->capacity) {     // Grow chars
+        while (pool->used + length > pool->capacity)
+            pool->capacity *= 2;
+        pool->chars = (char *) realloc(pool->chars, pool->capacity);
+    }
+    memcpy(pool->chars + pool->used, name, length);
+    pool->slots[slot] = pool->used + 1;
+    pool->used += length;
+
+    if (++pool->count * 2 > pool->slotCount) {      // Keep table at most half full - rehash into one twice the size
+        int *old = pool->slots, oldCount = pool->slotCount;
+
+        pool->slotCount *= 2;
+        pool->slots = (int *) calloc(pool->slotCount, sizeof(int));
+        mask = pool->slotCount - 1;
+        for (int i = 0; i < oldCount; ++i) {
+            if (old[i] == 0)
+                continue;
+            slot = hashName(pool->chars + old[i] - 1) & mask;
+            while (pool->slots[slot] != 0)
+                slot = (slot + 1) & mask;
+            pool->slots[slot] = old[i];
+        }
+        free(old);
+    }
 
-    while (l2 <= high)
-        bkp_programs[i++] = programs[l2++];
+    return pool->used - length;
+}
 
-    for (i = low; i <= high; i++)
-        programs[i] = bkp_programs[i];
+/*
+ * Name of a program
+ *
+ * @function const char *getName
+ * @param StringPool *pool
+ * @param Program *program
+ *
+ */
+
+const char *getName(StringPool *pool, Program *program) {
+    return pool->chars + program->name;
 }
 
 /*
- * Sorting of Haystack elements - Merge Sort
+ * Release everything a string pool holds
+ *
+ * @function void destroyPool
+ * @param StringPool *pool
+ *
+ */
+
+void destroyPool(StringPool *pool) {
+    free(pool->chars);
+    free(pool->slots);
+}
+
+/*
+ * Sort key of a program - its length (or length / frequency ratio), with index
+ * of program in haystack, so sorting moves 16 byte keys instead of whole programs
+ *
+ * @structure ProgramKey
+ * @attribute unsigned long long key - Length or ratio, mapped to orders as unsigned
+ * @attribute int index - Index of program in haystack
+ * @identifier ProgramKey
+ *
+ */
+typedef struct ProgramKey {
+    unsigned long long key;
+    int index;
+} ProgramKey;
+
+
+/*
+ * Get sort key of a program. Unweighted - length with sign bit flipped.
+ * Weighted - bits of length / frequency as double, sign bit flipped for
+ * positive ratio and every bit flipped for negative, which orders the same
+ * as the ratio. Programs never accessed go last
+ *
+ * @function unsigned long long getKey
+ * @param Program *program
+ * @param int weighted - Order by length / frequency instead of length
+ * @return unsigned long long key
+ *
+ */
+
+unsigned long long getKey(Program *program, int weighted) {
+    unsigned long long bits;
+    double ratio;
+
+    if (!weighted)
+        return (unsigned) program->length ^ 0x80000000u;  // Negative lengths (if any) first
+    if (program->frequency == 0)
+        return ~0ULL;
+
+    ratio = (double) program->length / program->frequency;
+    memcpy(&bits, &ratio, sizeof(bits));
+
+    return bits >> 63 ? ~bits : bits ^ (1ULL << 63);
+}
+
+
+/*
+ * Sorting of Haystack elements - LSD Radix Sort over (key, index) keys,
+ * a byte of key per pass. Stable, so programs of same key keep input order.
+ * Programs themselves are never moved
  *
  * @function void sort
- * @param Program[] program
- * @param int low - Lower bound index
- * @param int high - Upper bound index
+ * @param Program[] programs - Haystack of Programs
+ * @param int[] order - Resultant indices of programs, by ascending key
+ * @param int progCount - Amount of programs in haystack
+ * @param int weighted - Key is length / frequency instead of length
  *
  */
 
-void sort(Program programs[MAX], int low, int high) {
-    int mid;
+void sort(Program *programs, int *order, int progCount, int weighted) {
+    ProgramKey *keys = (ProgramKey *) malloc((progCount + 1) * sizeof(ProgramKey));
+    ProgramKey *bkp_keys = (ProgramKey *) malloc((progCount + 1) * sizeof(ProgramKey));
+    ProgramKey *from = keys, *to = bkp_keys, *swap;
+    int count[256];
 
-    if (low < high) {
-        mid = (low + high) / 2;
-        sort(programs, low, mid);
-        sort(programs, mid + 1, high);
-        merge(programs, low, mid, high);
-    } else {
-        return;
+    for (int i = 0; i < progCount; ++i) {
+        keys[i].key = getKey(&programs[i], weighted);
+        keys[i].index = i;
     }
+
+    for (int shift = 0; shift < 64; shift += 8) {                 // Unweighted keys skip upper 4 passes, all 0 there
+        for (int d = 0; d < 256; ++d)
+            count[d] = 0;
+        for (int i = 0; i < progCount; ++i)
+            count[(from[i].key >> shift) & 0xFF]++;
+        if (progCount == 0 || count[(from[0].key >> shift) & 0xFF] == progCount)
+            continue;                               // Every key has same byte here, pass changes nothing
+
+        for (int d = 0, at = 0; d < 256; ++d) {     // Start of every byte value in output
+            int c = count[d];
+            count[d] = at;
+            at += c;
+        }
+        for (int i = 0; i < progCount; ++i)
+            to[count[(from[i].key >> shift) & 0xFF]++] = from[i];
+
+        swap = from;
+        from = to;
+        to = swap;
+    }
+
+    for (int i = 0; i < progCount; ++i)
+        order[i] = from[i].index;
+
+    free(keys);
+    free(bkp_keys);
+}
+
+/*
+ * Get amount of programs store() places on a tape
+ *
+ * @function int getTapeProgCount
+ * @param int tape - Index of tape
+ * @param int tapeCount - No. of tapes in storage
+ * @param int progCount - No. of programs stored
+ * @return int count - Programs on tape
+ *
+ */
+
+int getTapeProgCount(int tape, int tapeCount, int progCount) {
+    return (progCount - tape + tapeCount - 1) / tapeCount;     // Round robin - tape gets programs tape, tape + tapeCount...
+}
+
+/*
+ * Set up tape storage for programs
+ *
+ * @function void initStorage
+ * @param Storage *storage
+ * @param int tapeCount - No. of tapes in storage
+ * @param int progCount - No. of programs to be stored
+ *
+ */
+
+void initStorage(Storage *storage, int tapeCount, int progCount) {
+    storage->tapeCount = tapeCount;
+    storage->start = (int *) malloc((tapeCount + 1) * sizeof(int));
+    storage->programs = (int *) malloc((progCount + 1) * sizeof(int));
+}
+
+/*
+ * Release everything tape storage holds
+ *
+ * @function void destroyStorage
+ * @param Storage *storage
+ *
+ */
+
+void destroyStorage(Storage *storage) {
+    free(storage->start);
+    free(storage->programs);
 }
 
 /*
  * Storage of programs to tape storage (generalized)
  *
  * @function void store
- * @param Program[][] storage - Tape Storage
- * @param Program[] program - Haystack of Programs
- * @param int tapeCount - No. of tapes in storage
+ * @param Storage *storage - Tape Storage (index of program in haystack)
+ * @param int[] order - Indices of programs, in order of storing
  * @param int progCount - No. of programs to be stored
  *
  */
 
-void store(Program storage[MAX][MAX], Program programs[MAX], int tapeCount, int progCount) {
+void store(Storage *storage, int *order, int progCount) {
 
-    int tapeIter = 0, storageColIter = 0;
+    int tapeCount = storage->tapeCount;
 
-    for (int i = 0; i < progCount; ++i) {
-        storage[tapeIter][storageColIter] = programs[i];
-        tapeIter = (tapeIter + 1) % tapeCount;
-        if (tapeIter == 0) {
-            storageColIter++;
-        }
+    storage->start[0] = 0;
+    for (int t = 0; t < tapeCount; ++t) {                   // Room of every tape
+        storage->start[t + 1] = storage->start[t] + getTapeProgCount(t, tapeCount, progCount);
+    }
+
+    for (int i = 0; i < progCount; ++i) {                   // Round robin - i'th program goes to tape i % tapeCount, after i / tapeCount others
+        storage->programs[storage->start[i % tapeCount] + i / tapeCount] = order[i];
     }
 
 };
@@ -106,19 +347,102 @@ void store(Program storage[MAX][MAX], Program programs[MAX], int tapeCount, int
 /*
  * Storage of programs to tape storage (optimized)
  *
- * @function void store
- * @param Program[][] storage - Tape Storage
+ * @function void optimal_store
+ * @param Storage *storage - Tape Storage (index of program in haystack)
  * @param Program[] program - Haystack of Programs
- * @param int tapeCount - No. of tapes in storage
+ * @param int[] order - Resultant indices of programs, by ascending length
+ * @param int progCount - No. of programs to be stored
+ *
+ */
+
+void optimal_store(Storage *storage, Program *programs, int *order, int progCount) {
+
+    sort(programs, order, progCount, 0);
+
+    store(storage, order, progCount);
+
+}
+
+/*
+ * Restore heap of tapes downwards from a position - least loaded tape on top,
+ * lower tape number first among equally loaded
+ *
+ * @function void sift_down
+ * @param int[] heap - Tape indices
+ * @param long long[] load - Total length stored on every tape
+ * @param int size - Tapes in heap
+ * @param int at - Position to restore from
+ *
+ */
+
+void sift_down(int *heap, long long *load, int size, int at) {
+    int tape = heap[at];
+
+    while (2 * at + 1 < size) {
+        int child = 2 * at + 1;
+
+        if (child + 1 < size && (load[heap[child + 1]] < load[heap[child]]
+                || (load[heap[child + 1]] == load[heap[child]] && heap[child + 1] < heap[child])))
+            ++child;
+        if (load[heap[child]] > load[tape] || (load[heap[child]] == load[tape] && heap[child] > tape))
+            break;
+        heap[at] = heap[child];
+        at = child;
+    }
+    heap[at] = tape;
+}
+
+/*
+ * Storage of programs to tape storage (weighted by access frequency) - programs
+ * in ascending length / frequency, each to the tape with least length stored so
+ * far, from a min-heap of tapes on load. Retrieval of a program costs its
+ * frequency times the load of its tape, so that load is kept least
+ *
+ * @function void weighted_store
+ * @param Storage *storage - Tape Storage (index of program in haystack)
+ * @param Program[] program - Haystack of Programs
+ * @param int[] order - Resultant indices of programs, by ascending length / frequency
  * @param int progCount - No. of programs to be stored
  *
  */
 
-void optimal_store(Program storage[MAX][MAX], Program programs[MAX], int tapeCount, int progCount) {
+void weighted_store(Storage *storage, Program *programs, int *order, int progCount) {
 
-    sort(programs, 0, progCount - 1);
+    int tapeCount = storage->tapeCount;
+    int *heap = (int *) malloc(tapeCount * sizeof(int));
+    int *tapeOf = (int *) malloc((progCount + 1) * sizeof(int));     // Tape of i'th program in order
+    long long *load = (long long *) malloc(tapeCount * sizeof(long long));
 
-    store(storage, programs, tapeCount, progCount);
+    sort(programs, order, progCount, 1);
+
+    for (int t = 0; t < tapeCount; ++t) {                   // Every tape empty, heap already in order
+        heap[t] = t;
+        load[t] = 0;
+        storage->start[t + 1] = 0;
+    }
+
+    for (int i = 0; i < progCount; ++i) {
+        int tape = heap[0];
+
+        tapeOf[i] = tape;
+        load[tape] += programs[order[i]].length;
+        storage->start[tape + 1]++;
+        sift_down(heap, load, tapeCount, 0);                // Tape only grew, sinks to its place
+    }
+
+    storage->start[0] = 0;
+    for (int t = 0; t < tapeCount; ++t) {                   // Room of every tape
+        storage->start[t + 1] += storage->start[t];
+        heap[t] = storage->start[t];                        // Heap done with, reused as next free slot of tape
+    }
+
+    for (int i = 0; i < progCount; ++i) {
+        storage->programs[heap[tapeOf[i]]++] = order[i];
+    }
+
+    free(heap);
+    free(tapeOf);
+    free(load);
 
 }
 
@@ -126,14 +450,14 @@ void optimal_store(Program storage[MAX][MAX], Program programs[MAX], int tapeCou
  * View Tape Storage in user friendly format
  *
  * @function void view_storage
- * @param Program[][] storage
- * @param int tapeCount
- * @param int progCount
+ * @param Storage *storage
+ * @param Program[] programs
+ * @param StringPool *pool - Names of programs
  */
 
-void view_storage(Program storage[MAX][MAX], int tapeCount, int progCount){
+void view_storage(Storage *storage, Program *programs, StringPool *pool){
 
-    int tapeIter = 0, storageColIter = 0;
+    int rows = 0, last;
 
     /*
      * Storage display format
@@ -145,65 +469,133 @@ void view_storage(Program storage[MAX][MAX], int tapeCount, int progCount){
      */
 
     printf("tp\t");
-    for (int i = 0; i < tapeCount; ++i) {
+    for (int i = 0; i < storage->tapeCount; ++i) {
         printf("%d\t", i+1);
+        if (storage->start[i + 1] - storage->start[i] > rows)
+            rows = storage->start[i + 1] - storage->start[i];
     }
-    printf("\n\t");
-    for (int i = 0; i < progCount; ++i) {
-        printf("%s\t", storage[tapeIter][storageColIter].name);
-        tapeIter = (tapeIter + 1) % tapeCount;
-        if (tapeIter == 0) {
-            printf("\n\t");
-            storageColIter++;
+    for (int r = 0; r < rows; ++r) {
+        printf("\n\t");
+        for (last = storage->tapeCount - 1; storage->start[last] + r >= storage->start[last + 1]; --last);    // Row ends at last tape this long
+        for (int i = 0; i <= last; ++i) {
+            if (storage->start[i] + r < storage->start[i + 1])
+                printf("%s", getName(pool, &programs[storage->programs[storage->start[i] + r]]));
+            printf("\t");                                   // Short tape (weighted storage) - blank cell
         }
     }
 
 }
 
 /*
- * Get Retrieval time of a program from programs haystack
+ * Get Retrieval time of all programs on a tape - retrieving a program reads
+ * every program before it on its tape, so running sum of lengths is the
+ * retrieval time of each program in turn, counted once per access
  *
- * @function int getRT
+ * @function long long getRT
+ * @param Storage *storage - Tape Storage
  * @param Program[] programs - Haystack of programs
- * @param int progIndex - Index of program in haystack
- * @return int rt - Retrieval Time
+ * @param int tape - Index of tape
+ * @return long long rt - Total Retrieval Time of tape
  *
  */
 
-int getRT(Program programs[MAX], int progIndex) {
+long long getRT(Storage *storage, Program *programs, int tape) {
 
-    int rt = 0;
+    long long rt = 0, prefix = 0;
 
-    for (int i = 0; i <= progIndex; ++i) {
-        for (int j = 0; j <= progIndex-i; ++j) {
-            rt += programs[j].length;
-        }
+    for (int i = storage->start[tape]; i < storage->start[tape + 1]; ++i) {
+        prefix += programs[storage->programs[i]].length;   // Retrieval time of program
+        rt += prefix * programs[storage->programs[i]].frequency;
     }
 
     return rt;
 }
 
 /*
- * Get Mean Retrieval time of programs in haystack
+ * Get accesses of all programs on a tape
  *
- * @function int getMRT
+ * @function long long getAccesses
+ * @param Storage *storage - Tape Storage
  * @param Program[] programs - Haystack of programs
- * @param int progCount - Amount of programs in haystack
- * @return int mrt - Mean Retrieval Time
+ * @param int tape - Index of tape
+ * @return long long accesses - Sum of frequencies on tape
+ *
+ */
+
+long long getAccesses(Storage *storage, Program *programs, int tape) {
+
+    long long accesses = 0;
+
+    for (int i = storage->start[tape]; i < storage->start[tape + 1]; ++i) {
+        accesses += programs[storage->programs[i]].frequency;
+    }
+
+    return accesses;
+}
+
+/*
+ * Get Mean Retrieval time of a tape, per access
+ *
+ * @function long long getTapeMRT
+ * @param Storage *storage - Tape Storage
+ * @param Program[] programs - Haystack of programs
+ * @param int tape - Index of tape
+ * @return long long mrt - Mean Retrieval Time of tape (0 if tape is never accessed)
+ *
+ */
+
+long long getTapeMRT(Storage *storage, Program *programs, int tape) {
+    long long accesses = getAccesses(storage, programs, tape);
+
+    return accesses ? getRT(storage, programs, tape) / accesses : 0;
+}
+
+/*
+ * Get Mean Retrieval time of all programs in tape storage, per access
+ *
+ * @function long long getMRT
+ * @param Storage *storage - Tape Storage
+ * @param Program[] programs - Haystack of programs
+ * @return long long mrt - Mean Retrieval Time
+ *
+ */
+
+long long getMRT(Storage *storage, Program *programs) {
+
+    long long rt = 0, accesses = 0;
+
+    for (int i = 0; i < storage->tapeCount; ++i) {
+        rt += getRT(storage, programs, i);
+        accesses += getAccesses(storage, programs, i);
+    }
+
+    return accesses ? rt / accesses : 0;
+}
+
+/*
+ * View Mean Retrieval time of every tape, under its column of storage
  *
+ * @function void view_retrieval
+ * @param Storage *storage
+ * @param Program[] programs
  */
 
-int getMRT(Program programs[MAX], int progCount) {
-    return (getRT(programs, progCount - 1) / progCount);
+void view_retrieval(Storage *storage, Program *programs) {
+
+    printf("\nmrt\t");
+    for (int i = 0; i < storage->tapeCount; ++i) {
+        printf("%lld\t", getTapeMRT(storage, programs, i));
+    }
+
 }
 
 /*
  * Sample structure of programs haystack
  *
     Program programs[] = {
-         {"pg1", 5},                // Program instance - {(name), (length)}
-         {"pg2", 10},
-         {"pg3", 3},
+         {intern(&pool, "pg1"), 5, 1},      // Program instance - {(name offset), (length), (frequency)}
+         {intern(&pool, "pg2"), 10, 1},
+         {intern(&pool, "pg3"), 3, 1},
     };
  *
  */
@@ -212,36 +604,73 @@ int getMRT(Program programs[MAX], int progCount) {
  * Start of Execution
  */
 
-int main() {
+int main(int argc, char *argv[]) {
 
-    Program programs[MAX], storage[MAX][MAX];
+    Program *programs;
+    Storage storage;
+    StringPool pool;
+    char name[NAME_LIMIT];
+    int *order;                             // Tapes and sorted order refer to programs by index
     int progCount, tapeCount;
+    int weighted = argc > 1 && strcmp(argv[1], "-w") == 0;     // Program lines carry access frequency
 
-    scanf("%d %d", &progCount, &tapeCount);
+    if (argc > 1 + weighted) {
+        fprintf(stderr, "Usage: %s [-w]\n", argv[0]);
+        return 1;
+    }
+
+    if (scanf("%d %d", &progCount, &tapeCount) != 2 || progCount < 0 || tapeCount < 1) {
+        fprintf(stderr, "Malformed input\n");
+        return 1;
+    }
+
+    programs = (Program *) malloc((progCount + 1) * sizeof(Program));
+    order = (int *) malloc((progCount + 1) * sizeof(int));
+    initPool(&pool);
 
     for (int i = 0; i < progCount; ++i) {
-        scanf("%s %d", programs[i].name, &programs[i].length);
+        programs[i].frequency = 1;
+        if (scanf("%255s %d", name, &programs[i].length) != 2
+                || (weighted && (scanf("%d", &programs[i].frequency) != 1 || programs[i].frequency < 0))) {
+            fprintf(stderr, "Malformed input\n");
+            return 1;
+        }
+        programs[i].name = intern(&pool, name);     // Same name of many programs stored once
     }
 
-    sort(programs, 0, progCount-1);
+    initStorage(&storage, tapeCount, progCount);
+    if (weighted)
+        weighted_store(&storage, programs, order, progCount);
+    else
+        optimal_store(&storage, programs, order, progCount);
 
     printf("\n");
-    printf("%d", getMRT(programs, progCount));
+    printf("%lld", getMRT(&storage, programs));
 
     printf("\n\n");
     for (int i = 0; i < progCount; ++i) {
-        printf("{%s,%d} ", programs[i].name, programs[i].length);
+        printf("{%s,%d", getName(&pool, &programs[i]), programs[i].length);
+        if (weighted)
+            printf(",%d", programs[i].frequency);
+        printf("} ");
     }
 
     printf("\n\n");
     for (int i = 0; i < progCount; ++i) {
-        printf("{%s,%d} ", programs[i].name, programs[i].length);
+        printf("{%s,%d", getName(&pool, &programs[order[i]]), programs[order[i]].length);
+        if (weighted)
+            printf(",%d", programs[order[i]].frequency);
+        printf("} ");
     }
 
-    optimal_store(storage, programs, tapeCount, progCount);
-
     printf("\n\n");
-    view_storage(storage, tapeCount, progCount);
+    view_storage(&storage, programs, &pool);
+    view_retrieval(&storage, programs);
+
+    destroyStorage(&storage);
+    destroyPool(&pool);
+    free(programs);
+    free(order);
 
     return 0;
 
@@ -252,18 +681,24 @@ int main() {
  * (program count) (tape count)
  * ((program name) (program length)) [((program name) (program length))...]
  *
+ * With -w (weighted by access frequency)
+ *
+ * (program count) (tape count)
+ * ((program name) (program length) (access frequency)) [...]
+ *
  */
 
 /*
  * OUTPUT FORMAT
  *
- * (mean retrieval time)
+ * (mean retrieval time)     - per access, with -w
  *
- * (unsorted programs in haystack)
+ * (unsorted programs in haystack)      - {name,length[,frequency]}
  *
- * (sorted programs in haystack)
+ * (sorted programs in haystack)        - by length / frequency, with -w
  *
  * (optimally stored programs in tape)
+ * (mean retrieval time of every tape)
  *
  */
 
@@ -273,6 +708,7 @@ int main() {
  * tp   (tape_number)   [(tape_number)...]
  *      (program_name)  [(program_name)...]
  *      (program_name)  [(program_name)...]
+ * mrt  (tape_mrt)      [(tape_mrt)...]
  *
  */
 
@@ -292,15 +728,16 @@ pg3 3
  * OUTPUT
  *
 
-9
+7
 
-{pg3,3} {pg1,5} {pg2,10}
+{pg1,5} {pg2,10} {pg3,3}
 
 {pg3,3} {pg1,5} {pg2,10}
 
 tp	1	2
 	pg3	pg1
 	pg2
+mrt	8	5
 
  *
  */
\ No newline at end of file
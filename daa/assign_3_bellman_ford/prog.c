@@ -7,78 +7,207 @@
 
 #include <stdio.h>
 #include <limits.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
-
-#define MAX 50          // Max array (haystack) size limit - any array
+#include <ctype.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define ARENA_CHUNK 65536       // Min size of every further Arena chunk (bytes)
+#define SNAPSHOT_MAGIC "BFGS"   // First bytes of a binary graph snapshot
+#define SNAPSHOT_VERSION 1      // Layout version of binary graph snapshot
+#define NEG_INF INT_MIN         // Distance of vertices reachable from a negative cycle (-∞)
+#define OUTPUT_MAGIC "BFMR"     // First bytes of binary output
+#define WRITER_SIZE (4 << 20)   // Output buffer size (bytes), written out with a single write() when full
+
+typedef enum Engine {       // Relaxation engine used to solve the Map
+    ENGINE_AUTO,            // Dijkstra if graph has no negative edge, else classic
+    ENGINE_CLASSIC,         // V full sweeps over all edges
+    ENGINE_EARLY,           // Full sweeps, stop as soon as a sweep relaxes nothing
+    ENGINE_SPFA,            // Queue based, re-relax out edges of changed vertices only
+    ENGINE_PARALLEL,        // Jacobi style sweeps over in edges, split across worker threads
+    ENGINE_DIJKSTRA         // Binary heap Dijkstra, valid only without negative edges
+} Engine;
+
+const char *engineNames[] = {"auto", "classic", "early", "spfa", "parallel", "dijkstra"};      // Names accepted by '-e' option (indexed by Engine)
+
+typedef enum OutputFormat { // Format of reported Maps
+    FORMAT_TABLE,           // Human readable table and routes
+    FORMAT_TSV,             // Tab separated rows per vertex
+    FORMAT_BINARY           // Raw int arrays
+} OutputFormat;
+
+const char *formatNames[] = {"table", "tsv", "bin"};            // Names accepted by '-o' option (indexed by OutputFormat)
+
+typedef struct Arena {      // Chain of memory chunks, objects are carved out one after other and freed all at once
+    char *base;             // Start of current chunk
+    size_t size, used;      // Capacity and used bytes of current chunk
+    struct Arena *prev;     // Previous (full) chunk, NULL for the first one
+} Arena;
 
 typedef struct Vertex {     // Vertex in Graph
-    char name[MAX];
+    char *name;             // Interned name (in Graph arena)
 } Vertex;
 
 typedef struct Edge {       // Edge in Graph
-    Vertex *src, *dest;
+    int src, dest;          // Indices of source and destination vertices (in graph->vertices)
     int weight;
 } Edge;
 
 typedef struct Graph {      // Complete Graph
     int V, E;               // V - No. of Vertices, E - No. of Edges (in Graph)
-    Edge **edges;           // Array of pointer to edges (can allocate dynamically)
-    Vertex **vertices;      // Array of pointer to vertices (can allocate dynamically)
+    int hasNegative;        // Does any edge have negative weight (set while loading edges)
+    Arena *arena;           // Storage of vertices, edges, names and CSR arrays
+    Edge *edges;            // Array of edges (in arena)
+    Vertex *vertices;       // Array of vertices (in arena)
+    int *nameIndex;         // Open addressing hash table of vertex indices by name (-1 - empty slot)
+    int nameIndexSize;      // No. of slots in nameIndex (power of 2, at least 2 * V)
+    int *offsets;           // CSR - Out edges of vertex 'u' lie in [offsets[u], offsets[u + 1])
+    int *targets;           // CSR - Destination vertex index of each out edge
+    int *weights;           // CSR - Weight of each out edge
+    int *inOffsets;         // Reverse CSR - In edges of vertex 'v' lie in [inOffsets[v], inOffsets[v + 1]) (NULL until built)
+    int *inSources;         // Reverse CSR - Source vertex index of each in edge
+    int *inWeights;         // Reverse CSR - Weight of each in edge
+    void *mapping;          // Mapped snapshot file the arrays point into (NULL if loaded from text)
+    size_t mappingSize;
 } Graph;
 
+/*
+ * Header of binary graph snapshot, followed by (all int)
+ *
+ *  offsets[V + 1], targets[E], weights[E]      - CSR arrays
+ *  nameIndex[nameIndexSize]                    - Name hash index
+ *  nameOffsets[V]                              - Offset of name of each vertex in name table
+ *  names[nameBytes]                            - Name table, NUL terminated names (char)
+ *
+ * @structure SnapshotHeader
+ * @identifier SnapshotHeader
+ */
+typedef struct SnapshotHeader {
+    char magic[4];              // SNAPSHOT_MAGIC
+    int version;                // SNAPSHOT_VERSION
+    int V, E;
+    int hasNegative;
+    int nameIndexSize;
+    int nameBytes;
+} SnapshotHeader;
+
 typedef struct Map {        // Resultant mapping of distances and parents
     int *distances;         // Distance from Parent Vertex
-    Vertex **parents;       // Array of Parent Vertices of all Vertices (Parent - Closest way possible to approach from some source Vertex)
+    int *parents;           // Index of Parent Vertex of all Vertices (Parent - Closest way possible to approach from some source Vertex), -1 if none
+    int witness;            // Index of vertex whose parent chain enters a negative cycle, -1 if none found
 } Map;
 
+typedef struct Writer {     // Buffered output, few large write() calls instead of many small printf() calls
+    char *buffer;
+    size_t size, used;      // Capacity and used bytes of buffer
+    int fd;                 // File descriptor to write to
+} Writer;
+
+typedef struct Report {     // Where and how solved Maps are reported
+    Writer *writer;
+    OutputFormat format;
+    int batch;              // Reporting many sources (batch query)
+} Report;
+
 /*
- * Get Index of Some Vertex stored in all Vertices of Graph
+ * Creates Arena instance with a first chunk of given size and returns reference to it
  *
- * @function int getVertexIndex
- * @param Vertex **vertices - Haystack
- * @param Vertex *vertex - Needle
- * @param int vertexCount - Amount of elements in Haystack
+ * @function Arena *createArena
+ * @param size_t size - Capacity of first chunk (bytes)
  */
 
-int getVertexIndex(Vertex **vertices, Vertex *vertex, int vertexCount) {
+Arena *createArena(size_t size) {
 
-    int i;
+    Arena *arena = (struct Arena *) malloc(sizeof(struct Arena));
 
-    for (i = 0; i < vertexCount; ++i) {         // Iterate through all vertices in Haystack
-        if (vertices[i] == vertex)              // If needle vertex address same as in haystack vertex
-            return i;                           // Return Index
-    }
-    if (i >= vertexCount)                       // Fallback - Not found, hence iterator 'i' goes out of bound
-        return -1;                              // Hence, return -1 - invalid index
+    arena->base = (char *) malloc(size);
+    arena->size = size;
+    arena->used = 0;
+    arena->prev = NULL;
+
+    return arena;
 }
 
 /*
- * Find Vertex using Data of Vertex
+ * Carve out memory of given size from Arena (aligned for any type),
+ * a new chunk is chained when current one is full
  *
- * @function Vertex *getVertexByName
- * @param Vertex **vertices - Haystack
- * @param char name[MAX] - Needle
- * @param int vertexCount - Amount of elements in Haystack
+ * @function void *arenaAlloc
+ * @param Arena *arena
+ * @param size_t size - Bytes required
  */
 
-Vertex *getVertexByName(Vertex **vertices, char name[MAX], int vertexCount) {
+void *arenaAlloc(Arena *arena, size_t size) {
+
+    size_t align = _Alignof(max_align_t);
+    size_t start = (arena->used + align - 1) & ~(align - 1);
 
-    int i;
+    if (start + size > arena->size) {                                   // Current chunk full, move it behind a new one
+        Arena *full = (struct Arena *) malloc(sizeof(struct Arena));
+        *full = *arena;
 
-    for (i = 0; i < vertexCount; ++i) {                 // Iterate through all vertices in Haystack
-        if (strcmp(vertices[i]->name, name) == 0)       // If needle data same as haystack vertex data
-            return vertices[i];                         // Return Reference to Vertex
+        arena->size = (size > ARENA_CHUNK) ? size : ARENA_CHUNK;
+        arena->base = (char *) malloc(arena->size);
+        arena->prev = full;
+        start = 0;
     }
-    if (i >= vertexCount) {                             // Fallback - Not found, hence iterator 'i' goes out of bound
-        return NULL;                                    // Hence, return NULL - No address
+
+    arena->used = start + size;
+
+    return arena->base + start;
+}
+
+/*
+ * Store a copy of string in Arena with exact length and return reference to it
+ *
+ * @function char *arenaString
+ * @param Arena *arena
+ * @param char *str
+ */
+
+char *arenaString(Arena *arena, char *str) {
+
+    size_t length = strlen(str) + 1;
+    char *copy;
+
+    if (arena->used + length > arena->size) {                          // Avoid aligning, strings need none
+        copy = (char *) arenaAlloc(arena, length);
+    } else {
+        copy = arena->base + arena->used;
+        arena->used += length;
     }
 
+    return memcpy(copy, str, length);
+}
+
+/*
+ * Free all chunks of Arena (and so everything carved out of it)
+ *
+ * @function void destroyArena
+ * @param Arena *arena
+ */
+
+void destroyArena(Arena *arena) {
+
+    while (arena != NULL) {
+        Arena *prev = arena->prev;
+        free(arena->base);
+        free(arena);
+        arena = prev;
+    }
 }
 
 /*
  * Creates a Graph instance and return reference to it
  *
+ * Vertices, edges and CSR arrays are carved out of a single Arena chunk,
+ * vertex names are interned into the same Arena as they are read
+ *
  * @function Graph *graph
  * @param int V - No. of Vertices
  * @param int E - No. of Edges
@@ -87,269 +216,2140 @@ Vertex *getVertexByName(Vertex **vertices, char name[MAX], int vertexCount) {
 Graph *createGraph(int V, int E) {
 
     Graph *graph = (struct Graph *) malloc(sizeof(struct Graph));               // Create instance of Graph
+    size_t align = _Alignof(max_align_t);
+    size_t bytes = V * sizeof(Vertex) + E * sizeof(Edge)                        // Vertices, Edges,
+                   + (V + 1 + 2 * (size_t) E) * sizeof(int)                     // CSR arrays,
+                   + 4 * align                                                  // padding between them,
+                   + V * 8;                                                     // and room for short names
 
     graph->V = V;                                                               // Assign total vertex count
     graph->E = E;                                                               // Assign total edges count
+    graph->hasNegative = 0;                                                     // No edges loaded yet
+
+    graph->arena = createArena(bytes);                                          // Single allocation for whole Graph
+    graph->edges = (Edge *) arenaAlloc(graph->arena, E * sizeof(Edge));         // Create instance of Edges (Amount of edges * size of Edge)
+    graph->vertices = (Vertex *) arenaAlloc(graph->arena, V * sizeof(Vertex));  // Create instance of Vertices (Amount of vertices * size of Vertex)
 
-    graph->edges = (Edge **) malloc(graph->E * sizeof(Edge *));                 // Create instance of Edges (Amount of edges * size of Edge)
-    for (int i = 0; i < E; ++i)
-        graph->edges[i] = (Edge *) malloc(graph->E * sizeof(Edge));             // Create instance of Individual empty Edges
+    graph->offsets = (int *) arenaAlloc(graph->arena, (V + 1) * sizeof(int));   // CSR arrays, filled by buildCSR() once edges are loaded
+    graph->targets = (int *) arenaAlloc(graph->arena, E * sizeof(int));
+    graph->weights = (int *) arenaAlloc(graph->arena, E * sizeof(int));
 
-    graph->vertices = (Vertex **) malloc(graph->V * sizeof(Vertex *));          // Create instance of Vertices (Amount of vertices * size of Vertex)
-    for (int i = 0; i < V; ++i)
-        graph->vertices[i] = (Vertex *) malloc(graph->V * sizeof(Vertex));      // Create instance of Individual empty Vertices
+    graph->inOffsets = graph->inSources = graph->inWeights = NULL;             // Reverse CSR, built by buildReverseCSR() when needed
+
+    for (graph->nameIndexSize = 1; graph->nameIndexSize < 2 * V; graph->nameIndexSize <<= 1);   // Load factor at most 1/2
+    graph->nameIndex = (int *) malloc(graph->nameIndexSize * sizeof(int));      // Name index, filled by addVertex()
+    memset(graph->nameIndex, -1, graph->nameIndexSize * sizeof(int));
+
+    graph->mapping = NULL;                                                      // Not a snapshot
+    graph->mappingSize = 0;
 
     return graph;       // Return reference to Graph instance
 }
 
 /*
- * Creates Map instance and returns reference to it
+ * Free Graph instance along with everything stored in its Arena
  *
- * @function Map *createMap
- * @param int V - No. of Vertices
+ * @function void destroyGraph
+ * @param Graph *graph
  */
 
-Map *createMap(int V) {
+void destroyGraph(Graph *graph) {
 
-    Map *map = (struct Map *) malloc(sizeof(struct Map));           // Create instance of Map
+    destroyArena(graph->arena);
 
-    map->distances = (int *) malloc(V * sizeof(int));               // Instantiate distances to No. of Vertices * size of int instances (array)
-    map->parents = (Vertex **) malloc(V * sizeof(Vertex *));        // Instantiate distances to No. of Vertices * size of Vertex instances (array)
+    if (graph->mapping != NULL)                                                 // CSR arrays and name index live in snapshot
+        munmap(graph->mapping, graph->mappingSize);
+    else
+        free(graph->nameIndex);
 
-    return map;     // Return reference to Map instance
+    free(graph);
 }
 
 /*
- * Display map in Table Plot
+ * Hash of vertex name - FNV-1a
  *
- * @function void viewMap
- * @param Map *map
- * @param Graph *map
+ * @function unsigned int hashName
+ * @param char *name
  */
 
-void viewMap(Map *map, Graph *graph) {
+unsigned int hashName(char *name) {
+
+    unsigned int hash = 2166136261u;
+
+    while (*name) {
+        hash ^= (unsigned char) *name++;
+        hash *= 16777619u;
+    }
 
-    printf("\n\nvertices:");
-    for (int i = 0; i < graph->V; ++i)                 // Display Vertex Names
-        printf("\t%s", graph->vertices[i]->name);
+    return hash;
+}
 
+/*
+ * Find slot of name in name index of Graph - either the slot holding vertex
+ * of same name or the empty slot where it would be inserted (linear probing)
+ *
+ * @function int findNameSlot
+ * @param Graph *graph
+ * @param char *name
+ */
 
-    printf("\ndistances:");
-    for (int i = 0; i < graph->V; ++i)                 // Display Vertex Distances from Parent
-        if(map->distances[i] != INT_MAX)                // If distance not infinity, show
-            printf("\t%d", map->distances[i]);
-        else                                            // else show Infinity symbol
-            printf("\t%c", '∞');
+int findNameSlot(Graph *graph, char *name) {
 
+    int mask = graph->nameIndexSize - 1;
+    int slot = (int) (hashName(name) & mask);
 
-    printf("\nparents:");
-    for (int i = 0; i < graph->V; ++i)                 // Display Vertex Parent Names
-        printf("\t%s", (map->parents[i]) ? map->parents[i]->name : "-");
+    while (graph->nameIndex[slot] != -1 && strcmp(graph->vertices[graph->nameIndex[slot]].name, name) != 0)
+        slot = (slot + 1) & mask;                                       // Occupied by other name, probe next
 
+    return slot;
 }
 
 /*
- * Show Route from particular Source to Destination Vertex
+ * Name a Vertex and index it by that name, a repeated name is interned
+ * (shares the string of its first Vertex, lookups find the first Vertex)
  *
- * @function void viewPath
- * @param Map *map
+ * Returns index of Vertex the name refers to
+ *
+ * @function int addVertex
  * @param Graph *graph
- * @param Vertex *src
- * @param Vertex *dest
+ * @param int index - Index of Vertex to name
+ * @param char *name
  */
 
-void viewPath(Map *map, Graph *graph, Vertex *src, Vertex *dest) {
+int addVertex(Graph *graph, int index, char *name) {
 
-    int destIndex = getVertexIndex(graph->vertices, dest, graph->V);            // Preload vertex index for further usage
+    int slot = findNameSlot(graph, name);
 
-    Vertex *iter = dest;                                                        // Backup destination vertex for iterating
+    if (graph->nameIndex[slot] != -1) {                                 // Name already known
+        graph->vertices[index].name = graph->vertices[graph->nameIndex[slot]].name;
+        return graph->nameIndex[slot];
+    }
 
-    printf("\n\nPath: %s => %s", src->name, iter->name);                        // Show path source and destination names of vertices
-    printf("\nCost: %d", map->distances[destIndex]);                            // Show Cost of path
+    graph->vertices[index].name = arenaString(graph->arena, name);
+    graph->nameIndex[slot] = index;
 
-    printf("\nRoute: ");                                                        // Start route printing
+    return index;
+}
 
-    do {
-        printf("%s <= ", iter->name);                                           // Show vertex name
-        iter = map->parents[getVertexIndex(graph->vertices, iter, graph->V)];   // Get address stored in Parent of current iterating Vertex from map
-    } while (iter != src);                                                      // Iterate until source vertex not reached
+/*
+ * Find Index of Vertex using Data of Vertex - O(1) with name index
+ *
+ * @function int getVertexIndexByName
+ * @param Graph *graph
+ * @param char *name - Needle
+ */
 
-    printf("%s", src->name);                                                    // At last, print source vertex data(name)
+int getVertexIndexByName(Graph *graph, char *name) {
 
+    return graph->nameIndex[findNameSlot(graph, name)];                 // -1 (empty slot) if not found
 }
 
 /*
- * Show Paths to all Vertices from a Source Vertex
+ * Pack loaded Edges into CSR (compressed sparse row) arrays grouped by source vertex,
+ * so that the solver only walks contiguous integer arrays.
+ * Edges of the same source keep their input order (counting sort - stable).
  *
- * @function void viewAllPaths
- * @param Map *map
+ * @function void buildCSR
  * @param Graph *graph
- * @param Vertex *src
  */
 
-void viewAllPaths(Map *map, Graph *graph, Vertex *src) {
+void buildCSR(Graph *graph) {
 
-    int srcIndex = getVertexIndex(graph->vertices, src, graph->V);      // Preload vertex index for further usage
+    for (int u = 0; u <= graph->V; ++u)                         // Reset out degree counters
+        graph->offsets[u] = 0;
 
-    for (int i = 0; i < graph->V; ++i) {                                // Iterate through all Vertices
+    for (int j = 0; j < graph->E; ++j)                          // Count out degree of each vertex (shifted by 1)
+        graph->offsets[graph->edges[j].src + 1]++;
 
-        if (i == srcIndex)                                              // No use showing path to self, hence ignore and continue
-            continue;
+    for (int u = 0; u < graph->V; ++u)                          // Prefix sum - start of out edges of each vertex
+        graph->offsets[u + 1] += graph->offsets[u];
 
-        viewPath(map, graph, src, graph->vertices[i]);                  // Until then, show path to the iterating destination vertex
+    int *next = (int *) malloc(graph->V * sizeof(int));         // Next free slot of each vertex
+    memcpy(next, graph->offsets, graph->V * sizeof(int));
 
+    for (int j = 0; j < graph->E; ++j) {                        // Scatter edges into their source vertex slots
+        int slot = next[graph->edges[j].src]++;
+        graph->targets[slot] = graph->edges[j].dest;
+        graph->weights[slot] = graph->edges[j].weight;
     }
 
+    free(next);
 }
 
 /*
- * Initial set up of Map to Infinity and Null Parents
+ * Pack in edges of every vertex into reverse CSR arrays (from the forward CSR),
+ * in edges of a vertex are ordered by source vertex index
  *
- * @function void initSingleSource
- * @param Map *map
+ * @function void buildReverseCSR
  * @param Graph *graph
- * @param Vertex *src
  */
 
-void initSingleSource(Map *map, Graph *graph, Vertex *src) {
+void buildReverseCSR(Graph *graph) {
 
-    int srcIndex = getVertexIndex(graph->vertices, src, graph->V);      // Preload vertex index for further usage
+    if (graph->inOffsets != NULL)                               // Already built
+        return;
 
-    for (int i = 0; i < graph->V; ++i) {                                // For all vertices (actually using their indexes)
-        map->distances[i] = INT_MAX;                                    // Set distance to Infinity
-        map->parents[i] = NULL;                                         // Set parent to Nobody (NULL)
+    graph->inOffsets = (int *) arenaAlloc(graph->arena, (graph->V + 1) * sizeof(int));
+    graph->inSources = (int *) arenaAlloc(graph->arena, graph->E * sizeof(int));
+    graph->inWeights = (int *) arenaAlloc(graph->arena, graph->E * sizeof(int));
+
+    memset(graph->inOffsets, 0, (graph->V + 1) * sizeof(int));
+
+    for (int j = 0; j < graph->E; ++j)                          // Count in degree of each vertex (shifted by 1)
+        graph->inOffsets[graph->targets[j] + 1]++;
+
+    for (int v = 0; v < graph->V; ++v)                          // Prefix sum - start of in edges of each vertex
+        graph->inOffsets[v + 1] += graph->inOffsets[v];
+
+    int *next = (int *) malloc(graph->V * sizeof(int));         // Next free slot of each vertex
+    memcpy(next, graph->inOffsets, graph->V * sizeof(int));
+
+    for (int u = 0; u < graph->V; ++u) {                        // Scatter out edges into their destination vertex slots
+        for (int j = graph->offsets[u]; j < graph->offsets[u + 1]; ++j) {
+            int slot = next[graph->targets[j]]++;
+            graph->inSources[slot] = u;
+            graph->inWeights[slot] = graph->weights[j];
+        }
     }
 
-    map->distances[srcIndex] = 0;                                       // Set self distance to '0'
+    free(next);
+}
+
+/*
+ * Read a (whitespace separated) name of any length from standard input,
+ * into a buffer grown as needed
+ *
+ * Returns '1' if a name was read else '0' (end of input)
+ *
+ * @function int readName
+ * @param char **buffer - Heap buffer holding the name (reallocated when too small)
+ * @param size_t *size - Capacity of buffer (bytes)
+ */
+
+int readName(char **buffer, size_t *size) {
 
+    size_t length = 0;
+    int c;
+
+    while ((c = getchar_unlocked()) != EOF && isspace(c));             // Skip leading whitespace
+
+    while (c != EOF && !isspace(c)) {
+        if (length + 1 >= *size) {                                      // Keep room for terminator
+            *size *= 2;
+            *buffer = (char *) realloc(*buffer, *size);
+        }
+        (*buffer)[length++] = (char) c;
+        c = getchar_unlocked();
+    }
+    (*buffer)[length] = '\0';
+
+    return length > 0;
 }
 
 /*
- * Relaxation of Vertices in Map - Finding closest backtrack parent vertex,
- * who can reach us with least distance from some source vertex
+ * Read Graph in text format (see INPUT FORMAT) from standard input,
+ * with CSR arrays built
  *
- * @function void relax
- * @param Map *map
- * @param Graph *graph
- * @param Edge *edge
+ * Returns NULL if input is malformed or some edge refers to an unknown vertex
+ *
+ * @function Graph *readGraph
  */
 
-void relax(Map *map, Graph *graph, Edge *edge) {
+Graph *readGraph() {
 
-    int uIndex = getVertexIndex(graph->vertices, edge->src, graph->V);      // Get source vertex Index
-    int vIndex = getVertexIndex(graph->vertices, edge->dest, graph->V);     // Get destination vertex Index
+    int V, E, weight;
+    size_t srcSize = 64, destSize = 64;
+    char *srcname = (char *) malloc(srcSize), *destname = (char *) malloc(destSize);   // Names of any length, only copy kept is interned in arena
+    Graph *graph;
 
-    if (
-            map->distances[vIndex]                                          // If current parent reach distance >
-            >
-            map->distances[uIndex] + edge->weight                           // Currently iterating source + weight of edge connecting them
-            ) {                                                             // Then take new source, as it has lesser distance, else ignore
+    if (scanf("%d %d", &V, &E) != 2 || V < 0 || E < 0) {               // Accept No. of Vertices and Edges
+        fprintf(stderr, "Malformed input\n");
+        free(srcname);
+        free(destname);
+        return NULL;
+    }
+
+    graph = createGraph(V, E);          // Set up Graph
 
-        map->distances[vIndex] = map->distances[uIndex] + edge->weight;     // Set new distance from new adjacent source vertex
-        map->parents[vIndex] = edge->src;                                   // Set new adjacent source vertex as parent
+    for (int i = 0; i < V; ++i) {                   // Accept Vertex Names
+        if (!readName(&srcname, &srcSize)) {
+            fprintf(stderr, "Malformed input\n");
+            free(srcname);
+            free(destname);
+            destroyGraph(graph);
+            return NULL;
+        }
+        addVertex(graph, i, srcname);               // Intern and index name
+    }
 
+    for (int i = 0; i < E; ++i) {                   // Accept and create Edges
+        if (!readName(&srcname, &srcSize) || !readName(&destname, &destSize) || scanf("%d", &weight) != 1) {
+            fprintf(stderr, "Malformed input\n");
+            free(srcname);
+            free(destname);
+            destroyGraph(graph);
+            return NULL;
+        }
+        graph->edges[i].src = getVertexIndexByName(graph, srcname);
+        graph->edges[i].dest = getVertexIndexByName(graph, destname);
+        graph->edges[i].weight = weight;
+
+        if (graph->edges[i].src == -1 || graph->edges[i].dest == -1) {
+            fprintf(stderr, "Unknown vertex in edge '%s %s'\n", srcname, destname);
+            free(srcname);
+            free(destname);
+            destroyGraph(graph);
+            return NULL;
+        }
+        graph->hasNegative |= (weight < 0);         // Decides engine in auto mode
     }
+
+    free(srcname);
+    free(destname);
+
+    buildCSR(graph);                                // Pack edges into integer CSR arrays, once
+
+    return graph;
 }
 
 /*
- * Bellman Ford - To find shortest path, from
- * some source to destination vertex
+ * Write Graph (CSR arrays, name index and names) to binary snapshot file
  *
- * Returns '0' if negative cycle exists else '1'
+ * Returns '1' if written else '0'
  *
- * @function int bellmanFord
- * @param Map *map
+ * @function int writeSnapshot
  * @param Graph *graph
- * @param Vertex *src
+ * @param char *path - Snapshot file
  */
 
-int bellmanFord(Map *map, Graph *graph, Vertex *src) {
+int writeSnapshot(Graph *graph, char *path) {
 
-    initSingleSource(map, graph, src);              // Set up map for give source vertex
+    FILE *file = fopen(path, "wb");
+    SnapshotHeader header;
+    int *nameOffsets;
+    int nameBytes = 0;
+
+    if (file == NULL) {
+        perror(path);
+        return 0;
+    }
 
-    for (int i = 0; i < graph->V; ++i)             // For all vertices,
-        for (int j = 0; j < graph->E; ++j)         // Through edges,
-            relax(map, graph, graph->edges[j]);     // Relax the Vertices in Map
+    nameOffsets = (int *) malloc(graph->V * sizeof(int));
+    for (int i = 0; i < graph->V; ++i) {                                // Lay names out one after other
+        nameOffsets[i] = nameBytes;
+        nameBytes += (int) strlen(graph->vertices[i].name) + 1;
+    }
 
-    for (int j = 0; j < graph->E; ++j) {
-        int uIndex = getVertexIndex(graph->vertices, graph->edges[j]->src, graph->V);       // Preload source vertex Index
-        int vIndex = getVertexIndex(graph->vertices, graph->edges[j]->dest, graph->V);      // Preload destination vertex Index
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.V = graph->V;
+    header.E = graph->E;
+    header.hasNegative = graph->hasNegative;
+    header.nameIndexSize = graph->nameIndexSize;
+    header.nameBytes = nameBytes;
+
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(graph->offsets, sizeof(int), graph->V + 1, file);
+    fwrite(graph->targets, sizeof(int), graph->E, file);
+    fwrite(graph->weights, sizeof(int), graph->E, file);
+    fwrite(graph->nameIndex, sizeof(int), graph->nameIndexSize, file);
+    fwrite(nameOffsets, sizeof(int), graph->V, file);
+    for (int i = 0; i < graph->V; ++i)
+        fwrite(graph->vertices[i].name, 1, strlen(graph->vertices[i].name) + 1, file);
+
+    free(nameOffsets);
+
+    if (ferror(file) | fclose(file)) {
+        perror(path);
+        return 0;
+    }
 
-        if (                                                        // Still can find shorter path, means infinite iteration exists
-                map->distances[vIndex]                              // Hence, negative cycle exists
-                >
-                map->distances[uIndex] + graph->edges[j]->weight
-                ) {
+    return 1;
+}
 
-            return 0;                                               // Hence, return 0, as negative cycle exists
-        }
+/*
+ * Check mapped snapshot before anything in it is used - header fields and
+ * size, CSR offsets and targets, negative weight flag against the weights
+ * (it picks the engine in auto mode), name index entries, and that every name
+ * offset lies in the name table with its terminator there too - O(V + E)
+ *
+ * Returns '1' if valid else '0'
+ *
+ * @function int validSnapshot
+ * @param void *mapping - Mapped snapshot file
+ * @param size_t size - Size of file (bytes)
+ */
+
+int validSnapshot(void *mapping, size_t size) {
+
+    SnapshotHeader *header = (SnapshotHeader *) mapping;
+    int *offsets, *targets, *weights, *nameIndex, *nameOffsets;
+    char *names;
+    int V, E, emptySlots = 0, hasNegative = 0;
+
+    if (size < sizeof(SnapshotHeader)
+        || memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic)) != 0
+        || header->version != SNAPSHOT_VERSION
+        || header->V < 0 || header->E < 0 || header->nameBytes < 0
+        || header->nameIndexSize < 1 || (header->nameIndexSize & (header->nameIndexSize - 1)) != 0   // Power of 2, probing masks with it
+        || size != sizeof(SnapshotHeader)
+                   + ((size_t) header->V * 2 + 1 + (size_t) header->E * 2 + (size_t) header->nameIndexSize) * sizeof(int)
+                   + (size_t) header->nameBytes)
+        return 0;
+
+    V = header->V;
+    E = header->E;
+    offsets = (int *) (header + 1);
+    targets = offsets + V + 1;
+    weights = targets + E;
+    nameIndex = weights + E;
+    nameOffsets = nameIndex + header->nameIndexSize;
+    names = (char *) (nameOffsets + V);
+
+    if (offsets[0] != 0 || offsets[V] != E)
+        return 0;
+    for (int v = 0; v < V; ++v)                                         // Non decreasing, hence every offset within [0, E]
+        if (offsets[v] > offsets[v + 1])
+            return 0;
+
+    for (int j = 0; j < E; ++j) {
+        if (targets[j] < 0 || targets[j] >= V)
+            return 0;
+        hasNegative |= (weights[j] < 0);
     }
-    return 1;                                                       // Else return 1, as no negative cycle exists
+    if (header->hasNegative != hasNegative)                             // Dijkstra on a graph with negative edges may never finish
+        return 0;
+
+    for (int slot = 0; slot < header->nameIndexSize; ++slot) {
+        if (nameIndex[slot] == -1)
+            emptySlots++;
+        else if (nameIndex[slot] < 0 || nameIndex[slot] >= V)
+            return 0;
+    }
+    if (emptySlots == 0)                                                // Probing for unknown name would never stop
+        return 0;
+
+    for (int i = 0; i < V; ++i)                                         // Name starts in table and ends (NUL) before table does
+        if (nameOffsets[i] < 0 || nameOffsets[i] >= header->nameBytes
+            || memchr(names + nameOffsets[i], '\0', header->nameBytes - nameOffsets[i]) == NULL)
+            return 0;
+
+    return 1;
 }
 
 /*
- * Start of Execution
+ * Map binary snapshot file into memory and return Graph working directly over it,
+ * only vertex name references are allocated (no per edge parsing or allocation)
+ *
+ * Returns NULL if file is not a valid snapshot
+ *
+ * @function Graph *loadSnapshot
+ * @param char *path - Snapshot file
  */
 
-int main() {
+Graph *loadSnapshot(char *path) {
 
-    /*
-     * Prerequisites
-     */
-    int V, E;
-    Map *map;
+    int fd = open(path, O_RDONLY);
+    struct stat info;
+    void *mapping;
+    SnapshotHeader *header;
     Graph *graph;
-    Vertex *src;
-    char srcname[50];
-    char destname[50];
-    int weight;
+    int *data, *nameOffsets;
+    char *names;
+
+    if (fd == -1 || fstat(fd, &info) == -1) {
+        perror(path);
+        if (fd != -1)
+            close(fd);
+        return NULL;
+    }
+
+    if ((size_t) info.st_size < sizeof(SnapshotHeader)) {               // Too short to map even a header
+        fprintf(stderr, "'%s' is not a graph snapshot (version %d)\n", path, SNAPSHOT_VERSION);
+        close(fd);
+        return NULL;
+    }
 
-    scanf("%d %d", &V, &E);             // Accept No. of Vertices and Edges
+    mapping = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);                                                          // Mapping stays valid without descriptor
 
-    graph = createGraph(V, E);          // Set up Graph
-    map = createMap(V);                 // Set up Map
+    if (mapping == MAP_FAILED) {
+        perror(path);
+        return NULL;
+    }
+
+    header = (SnapshotHeader *) mapping;
 
-    for (int i = 0; i < V; ++i)
-        scanf("%s", graph->vertices[i]->name);      // Accept Vertex Names
+    if (!validSnapshot(mapping, info.st_size)) {                        // Validate everything before trusting any offset
+        fprintf(stderr, "'%s' is not a graph snapshot (version %d)\n", path, SNAPSHOT_VERSION);
+        munmap(mapping, info.st_size);
+        return NULL;
+    }
 
+    graph = (struct Graph *) malloc(sizeof(struct Graph));
 
+    graph->V = header->V;
+    graph->E = header->E;
+    graph->hasNegative = header->hasNegative;
+    graph->mapping = mapping;
+    graph->mappingSize = info.st_size;
 
-    for (int i = 0; i < E; ++i) {                   // Accept and create Edges
-        scanf("%s %s %d", srcname, destname, &weight);
-        graph->edges[i]->src = getVertexByName(graph->vertices, srcname, graph->V);
-        graph->edges[i]->dest = getVertexByName(graph->vertices, destname, graph->V);
-        graph->edges[i]->weight = weight;
+    data = (int *) (header + 1);                                        // Arrays follow header
+    graph->offsets = data;
+    graph->targets = data += graph->V + 1;
+    graph->weights = data += graph->E;
+    graph->nameIndex = data += graph->E;
+    graph->nameIndexSize = header->nameIndexSize;
+    nameOffsets = data += graph->nameIndexSize;
+    names = (char *) (data + graph->V);
+
+    graph->arena = createArena(graph->V * sizeof(Vertex) + _Alignof(max_align_t));
+    graph->edges = NULL;                                                // Edge list is not kept, CSR is all the solver needs
+    graph->vertices = (Vertex *) arenaAlloc(graph->arena, graph->V * sizeof(Vertex));
+    for (int i = 0; i < graph->V; ++i)
+        graph->vertices[i].name = names + nameOffsets[i];
+
+    graph->inOffsets = graph->inSources = graph->inWeights = NULL;     // Reverse CSR, built by buildReverseCSR() when needed
+
+    return graph;
+}
+
+/*
+ * Creates Writer instance over a file descriptor and returns reference to it
+ *
+ * @function Writer *createWriter
+ * @param int fd - File descriptor to write to
+ * @param size_t size - Buffer capacity (bytes), flushed when full
+ */
+
+Writer *createWriter(int fd, size_t size) {
+
+    Writer *writer = (struct Writer *) malloc(sizeof(struct Writer));
 
+    writer->buffer = (char *) malloc(size);
+    writer->size = size;
+    writer->used = 0;
+    writer->fd = fd;
+
+    return writer;
+}
+
+/*
+ * Write all given bytes to file descriptor
+ *
+ * @function void writeAll
+ * @param int fd
+ * @param const char *data
+ * @param size_t length - No. of bytes
+ */
+
+void writeAll(int fd, const char *data, size_t length) {
+
+    while (length > 0) {                                                // write() may take less than asked
+        ssize_t written = write(fd, data, length);
+        if (written <= 0)
+            break;
+        data += written;
+        length -= written;
     }
+}
+
+/*
+ * Write out everything buffered in Writer
+ *
+ * @function void flushWriter
+ * @param Writer *writer
+ */
+
+void flushWriter(Writer *writer) {
+
+    writeAll(writer->fd, writer->buffer, writer->used);
+    writer->used = 0;
+}
 
-    src = graph->vertices[0];                       // Currently default source vertex set to 1st vertex
+/*
+ * Flush and free Writer instance
+ *
+ * @function void destroyWriter
+ * @param Writer *writer
+ */
+
+void destroyWriter(Writer *writer) {
+
+    flushWriter(writer);
+    free(writer->buffer);
+    free(writer);
+}
+
+/*
+ * Append bytes to Writer buffer
+ *
+ * @function void writeBytes
+ * @param Writer *writer
+ * @param const void *data
+ * @param size_t length - No. of bytes
+ */
 
-    int status = bellmanFord(map, graph, src);      // Receive status of Bellman Ford Algorithm for given source
+void writeBytes(Writer *writer, const void *data, size_t length) {
 
-    printf("\n%d", status);                         // Print status
+    if (writer->used + length > writer->size) {
+        flushWriter(writer);
 
-    if (status == 1){                               // Is no negative cycle present
-        viewMap(map, graph);                        // View Map to vertices from given source
-        viewAllPaths(map, graph, src);              // View Paths to all Vertices from given source
+        if (length > writer->size) {                                    // Larger than whole buffer, write through
+            writeAll(writer->fd, (const char *) data, length);
+            return;
+        }
     }
 
-    return 0;       // End of line
+    memcpy(writer->buffer + writer->used, data, length);
+    writer->used += length;
+}
+
+/*
+ * Append string to Writer buffer
+ *
+ * @function void writeString
+ * @param Writer *writer
+ * @param const char *str
+ */
+
+void writeString(Writer *writer, const char *str) {
 
+    writeBytes(writer, str, strlen(str));
 }
 
 /*
- * INPUT FORMAT
+ * Append decimal text of integer to Writer buffer
  *
- * (vertex count) (edges count)
- * (vertex name) [(vertex name)...]
- * ((source vertex name) (destination vertex name) (weight)) [((source vertex name) (destination vertex name) (weight))...]
+ * @function void writeInt
+ * @param Writer *writer
+ * @param int value
+ */
+
+void writeInt(Writer *writer, int value) {
+
+    char digits[12];
+    int length = 0;
+    unsigned int magnitude = (value < 0) ? 0u - (unsigned int) value : (unsigned int) value;
+
+    do {                                                                // Digits from lowest, filled from the end
+        digits[sizeof(digits) - 1 - length++] = (char) ('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+
+    if (value < 0)
+        digits[sizeof(digits) - 1 - length++] = '-';
+
+    writeBytes(writer, digits + sizeof(digits) - length, length);
+}
+
+/*
+ * Creates Map instance and returns reference to it
  *
+ * @function Map *createMap
+ * @param int V - No. of Vertices
  */
 
+Map *createMap(int V) {
+
+    Map *map = (struct Map *) malloc(sizeof(struct Map));           // Create instance of Map
+
+    map->distances = (int *) malloc(V * sizeof(int));               // Instantiate distances to No. of Vertices * size of int instances (array)
+    map->parents = (int *) malloc(V * sizeof(int));                 // Instantiate parents to No. of Vertices * size of int instances (array)
+    map->witness = -1;                                              // No negative cycle found yet
+
+    return map;     // Return reference to Map instance
+}
+
 /*
- * OUTPUT FORMAT
+ * Free Map instance
  *
- * (bellman ford status)
+ * @function void destroyMap
+ * @param Map *map
+ */
+
+void destroyMap(Map *map) {
+
+    free(map->distances);
+    free(map->parents);
+    free(map);
+}
+
+/*
+ * Display map in Table Plot
+ *
+ * @function void viewMap
+ * @param Writer *writer
+ * @param Map *map
+ * @param Graph *map
+ */
+
+void viewMap(Writer *writer, Map *map, Graph *graph) {
+
+    writeString(writer, "\n\nvertices:");
+    for (int i = 0; i < graph->V; ++i) {               // Display Vertex Names
+        writeString(writer, "\t");
+        writeString(writer, graph->vertices[i].name);
+    }
+
+
+    writeString(writer, "\ndistances:");
+    for (int i = 0; i < graph->V; ++i) {               // Display Vertex Distances from Parent
+        if (map->distances[i] == NEG_INF)               // Behind negative cycle, show -Infinity
+            writeString(writer, "\t-∞");
+        else if (map->distances[i] != INT_MAX) {        // If distance not infinity, show
+            writeString(writer, "\t");
+            writeInt(writer, map->distances[i]);
+        } else                                          // else show Infinity symbol
+            writeString(writer, "\t∞");
+    }
+
+
+    writeString(writer, "\nparents:");
+    for (int i = 0; i < graph->V; ++i) {               // Display Vertex Parent Names
+        writeString(writer, "\t");
+        writeString(writer, (map->parents[i] != -1) ? graph->vertices[map->parents[i]].name : "-");
+    }
+
+}
+
+/*
+ * Show Route from particular Source to Destination Vertex
+ *
+ * @function void viewPath
+ * @param Writer *writer
+ * @param Map *map
+ * @param Graph *graph
+ * @param int src - Index of source vertex
+ * @param int dest - Index of destination vertex
+ */
+
+void viewPath(Writer *writer, Map *map, Graph *graph, int src, int dest) {
+
+    int iter = dest;                                                            // Backup destination vertex for iterating
+
+    writeString(writer, "\n\nPath: ");                                          // Show path source and destination names of vertices
+    writeString(writer, graph->vertices[src].name);
+    writeString(writer, " => ");
+    writeString(writer, graph->vertices[dest].name);
+
+    if (map->distances[dest] == NEG_INF) {                                      // Behind negative cycle, no shortest route
+        writeString(writer, "\nCost: -∞\nRoute: -");
+        return;
+    }
+
+    if (map->distances[dest] == INT_MAX) {                                      // Not reachable, no route
+        writeString(writer, "\nCost: ∞\nRoute: -");
+        return;
+    }
+
+    writeString(writer, "\nCost: ");                                            // Show Cost of path
+    writeInt(writer, map->distances[dest]);
+
+    writeString(writer, "\nRoute: ");                                           // Start route printing
+
+    do {
+        writeString(writer, graph->vertices[iter].name);                        // Show vertex name
+        writeString(writer, " <= ");
+        iter = map->parents[iter];                                              // Get index stored in Parent of current iterating Vertex from map
+    } while (iter != src && iter != -1);                                        // Iterate until source vertex not reached
+
+    writeString(writer, graph->vertices[src].name);                             // At last, print source vertex data(name)
+
+}
+
+/*
+ * Show Paths to all Vertices from a Source Vertex
+ *
+ * @function void viewAllPaths
+ * @param Writer *writer
+ * @param Map *map
+ * @param Graph *graph
+ * @param int src - Index of source vertex
+ */
+
+void viewAllPaths(Writer *writer, Map *map, Graph *graph, int src) {
+
+    for (int i = 0; i < graph->V; ++i) {                                // Iterate through all Vertices
+
+        if (i == src)                                                   // No use showing path to self, hence ignore and continue
+            continue;
+
+        viewPath(writer, map, graph, src, i);                           // Until then, show path to the iterating destination vertex
+
+    }
+
+}
+
+/*
+ * Write Map as tab separated rows - (source) (vertex) (distance) (parent)
+ *
+ * @function void viewMapTSV
+ * @param Writer *writer
+ * @param Map *map
+ * @param Graph *graph
+ * @param int src - Index of source vertex
+ */
+
+void viewMapTSV(Writer *writer, Map *map, Graph *graph, int src) {
+
+    for (int i = 0; i < graph->V; ++i) {
+        writeString(writer, graph->vertices[src].name);
+        writeString(writer, "\t");
+        writeString(writer, graph->vertices[i].name);
+        writeString(writer, "\t");
+
+        if (map->distances[i] == NEG_INF)
+            writeString(writer, "-inf");
+        else if (map->distances[i] == INT_MAX)
+            writeString(writer, "inf");
+        else
+            writeInt(writer, map->distances[i]);
+
+        writeString(writer, "\t");
+        writeString(writer, (map->parents[i] != -1) ? graph->vertices[map->parents[i]].name : "-");
+        writeString(writer, "\n");
+    }
+}
+
+/*
+ * Write Map as binary record - (source index) distances[V] parents[V] (all int)
+ *
+ * @function void viewMapBinary
+ * @param Writer *writer
+ * @param Map *map
+ * @param Graph *graph
+ * @param int src - Index of source vertex
+ */
+
+void viewMapBinary(Writer *writer, Map *map, Graph *graph, int src) {
+
+    writeBytes(writer, &src, sizeof(int));
+    writeBytes(writer, map->distances, graph->V * sizeof(int));
+    writeBytes(writer, map->parents, graph->V * sizeof(int));
+}
+
+/*
+ * Read comma separated list of vertex names (or "all") into source vertex indices
+ *
+ * Returns No. of sources, -1 if some name is not a vertex
+ *
+ * @function int parseSources
+ * @param Graph *graph
+ * @param char *list - "all" or "name[,name...]" (modified)
+ * @param int **sources - Result, allocated array of source vertex indices
+ */
+
+int parseSources(Graph *graph, char *list, int **sources) {
+
+    int count = 0;
+
+    if (strcmp(list, "all") == 0) {                                     // Every vertex is a source
+        *sources = (int *) malloc(graph->V * sizeof(int));
+        for (int i = 0; i < graph->V; ++i)
+            (*sources)[count++] = i;
+        return count;
+    }
+
+    *sources = (int *) malloc((strlen(list) / 2 + 1) * sizeof(int));    // At most one source per 2 characters ("a,")
+
+    for (char *name = strtok(list, ","); name != NULL; name = strtok(NULL, ",")) {
+        int index = getVertexIndexByName(graph, name);
+
+        if (index == -1) {
+            fprintf(stderr, "Unknown source vertex '%s'\n", name);
+            return -1;
+        }
+
+        (*sources)[count++] = index;
+    }
+
+    return count;
+}
+
+/*
+ * Initial set up of Map to Infinity and Null Parents
+ *
+ * @function void initSingleSource
+ * @param Map *map
+ * @param Graph *graph
+ * @param int src - Index of source vertex
+ */
+
+void initSingleSource(Map *map, Graph *graph, int src) {
+
+    for (int i = 0; i < graph->V; ++i) {                                // For all vertices (actually using their indexes)
+        map->distances[i] = INT_MAX;                                    // Set distance to Infinity
+        map->parents[i] = -1;                                           // Set parent to Nobody (-1)
+    }
+
+    map->distances[src] = 0;                                            // Set self distance to '0'
+    map->witness = -1;                                                  // No negative cycle found yet
+
+}
+
+/*
+ * Relaxation of Vertices in Map - Finding closest backtrack parent vertex,
+ * who can reach us with least distance from some source vertex
+ *
+ * Returns '1' if the distance of destination vertex got shorter else '0'
+ *
+ * @function int relax
+ * @param Map *map
+ * @param Graph *graph
+ * @param int u - Index of source vertex of edge
+ * @param int slot - CSR slot of edge (in graph->targets / graph->weights)
+ */
+
+int relax(Map *map, Graph *graph, int u, int slot) {
+
+    int v = graph->targets[slot];                                           // Destination vertex Index
+
+    if (map->distances[u] == INT_MAX || map->distances[u] == NEG_INF)       // Source not reached yet (or behind negative cycle), nothing to offer
+        return 0;
+
+    if (
+            map->distances[v]                                               // If current parent reach distance >
+            >
+            map->distances[u] + graph->weights[slot]                        // Currently iterating source + weight of edge connecting them
+            ) {                                                             // Then take new source, as it has lesser distance, else ignore
+
+        map->distances[v] = map->distances[u] + graph->weights[slot];       // Set new distance from new adjacent source vertex
+        map->parents[v] = u;                                                // Set new adjacent source vertex as parent
+
+        return 1;
+    }
+
+    return 0;
+}
+
+/*
+ * Find an edge that can still be relaxed (with finite source) and relax it,
+ * after at least V - 1 sweeps this leaves a negative cycle in the parent
+ * chain of its destination vertex
+ *
+ * Returns index of destination vertex of that edge (witness), -1 if no edge can be relaxed
+ *
+ * @function int findNegativeCycle
+ * @param Map *map
+ * @param Graph *graph
+ */
+
+int findNegativeCycle(Map *map, Graph *graph) {
+
+    for (int u = 0; u < graph->V; ++u) {
+        if (map->distances[u] == INT_MAX || map->distances[u] == NEG_INF)  // Unreachable source, can not be part of a reachable cycle
+            continue;
+
+        for (int j = graph->offsets[u]; j < graph->offsets[u + 1]; ++j) {
+            if (relax(map, graph, u, j))                                // Still can find shorter path, means infinite iteration exists
+                return graph->targets[j];                               // Hence, negative cycle exists
+        }
+    }
+
+    return -1;
+}
+
+/*
+ * Walk parents V times from given vertex, and check that the walk is stuck
+ * in a cycle of parents (any such cycle is a negative cycle)
+ *
+ * Returns index of a vertex on the cycle, -1 if parent chain ends
+ *
+ * @function int findParentCycle
+ * @param Map *map
+ * @param Graph *graph
+ * @param int from - Index of vertex to start walk from
+ */
+
+int findParentCycle(Map *map, Graph *graph, int from) {
+
+    int x = from;
+
+    for (int i = 0; i < graph->V && x != -1; ++i)                      // V steps surely enter the cycle, if any
+        x = map->parents[x];
+
+    if (x == -1)
+        return -1;
+
+    for (int y = map->parents[x], i = 0; i < graph->V; y = map->parents[y], ++i) {  // Confirm we come back to 'x'
+        if (y == x)
+            return x;
+        if (y == -1)
+            return -1;
+    }
+
+    return -1;
+}
+
+/*
+ * Extract negative cycle found from witness vertex, in edge order
+ *
+ * Returns No. of vertices on cycle, '0' if there is no cycle behind witness
+ *
+ * @function int extractNegativeCycle
+ * @param Map *map
+ * @param Graph *graph
+ * @param int witness - Index of vertex whose parent chain enters the cycle
+ * @param int *cycle - Result, indices of cycle vertices (room for V)
+ */
+
+int extractNegativeCycle(Map *map, Graph *graph, int witness, int *cycle) {
+
+    int x = (witness == -1) ? -1 : findParentCycle(map, graph, witness);
+    int length = 0;
+
+    if (x == -1)
+        return 0;
+
+    int y = x;
+    do {                                                                // Parents give the cycle backwards
+        cycle[length++] = y;
+        y = map->parents[y];
+    } while (y != x);
+
+    for (int i = 0; i < length / 2; ++i) {                              // Reverse to edge order
+        int temp = cycle[i];
+        cycle[i] = cycle[length - 1 - i];
+        cycle[length - 1 - i] = temp;
+    }
+
+    return length;
+}
+
+/*
+ * Show negative cycle (as extracted by extractNegativeCycle)
+ *
+ * @function void viewNegativeCycle
+ * @param Writer *writer
+ * @param Graph *graph
+ * @param int *cycle - Indices of cycle vertices in edge order
+ * @param int length - No. of vertices on cycle
+ */
+
+void viewNegativeCycle(Writer *writer, Graph *graph, int *cycle, int length) {
+
+    writeString(writer, "\n\nNegative cycle: ");
+
+    for (int i = 0; i < length; ++i) {                                  // Show cycle vertices in edge order, back to first one
+        writeString(writer, graph->vertices[cycle[i]].name);
+        writeString(writer, " => ");
+    }
+
+    writeString(writer, (length > 0) ? graph->vertices[cycle[0]].name : "-");
+}
+
+/*
+ * Mark given vertices and every vertex reachable from them as -∞
+ * distance (breadth first over out edges) - O(V + E)
+ *
+ * @function void spreadNegativeInfinity
+ * @param Map *map
+ * @param Graph *graph
+ * @param int *seeds - Indices of vertices affected by a negative cycle (room for V, used as queue)
+ * @param int seedCount - No. of seeds
+ */
+
+void spreadNegativeInfinity(Map *map, Graph *graph, int *seeds, int seedCount) {
+
+    int *queue = seeds, size = 0;
+
+    for (int i = 0; i < seedCount; ++i) {                              // Queue seeds not marked yet
+        if (map->distances[seeds[i]] != NEG_INF) {
+            map->distances[seeds[i]] = NEG_INF;
+            queue[size++] = seeds[i];
+        }
+    }
+
+    for (int head = 0; head < size; ++head) {
+        int u = queue[head];
+
+        for (int j = graph->offsets[u]; j < graph->offsets[u + 1]; ++j) {
+            int v = graph->targets[j];
+
+            if (map->distances[v] != NEG_INF) {                         // Reachable from a negative cycle, no shortest path
+                map->distances[v] = NEG_INF;
+                queue[size++] = v;
+            }
+        }
+    }
+}
+
+/*
+ * After (at least) V - 1 full sweeps, mark every vertex reachable from a
+ * negative cycle as -∞, other vertices already hold final distances
+ * (one pass over edges, no further sweeps)
+ *
+ * @function void markNegativeInfinity
+ * @param Map *map
+ * @param Graph *graph
+ */
+
+void markNegativeInfinity(Map *map, Graph *graph) {
+
+    int *seeds = (int *) malloc(graph->V * sizeof(int));
+    int seedCount = 0;
+    char *seeded = (char *) calloc(graph->V, sizeof(char));
+
+    if (map->witness != -1) {
+        seeds[seedCount++] = map->witness;
+        seeded[map->witness] = 1;
+    }
+
+    for (int u = 0; u < graph->V; ++u) {                                // Only vertices behind a negative cycle can still be relaxed
+        if (map->distances[u] == INT_MAX || map->distances[u] == NEG_INF)
+            continue;
+
+        for (int j = graph->offsets[u]; j < graph->offsets[u + 1]; ++j) {
+            int v = graph->targets[j];
+
+            if (!seeded[v] && map->distances[v] > map->distances[u] + graph->weights[j]) {
+                seeds[seedCount++] = v;
+                seeded[v] = 1;
+            }
+        }
+    }
+
+    spreadNegativeInfinity(map, graph, seeds, seedCount);
+
+    free(seeds);
+    free(seeded);
+}
+
+/*
+ * Sweeps of Bellman Ford over already initialised Map - At most V sweeps
+ * over all edges, followed by negative cycle check
+ *
+ * Returns '0' if negative cycle exists (map->witness leads to it) else '1'
+ *
+ * @function int relaxAll
+ * @param Map *map
+ * @param Graph *graph
+ * @param int earlyExit - Stop sweeping as soon as a sweep relaxes nothing (1) or always run V sweeps (0)
+ */
+
+int relaxAll(Map *map, Graph *graph, int earlyExit) {
+
+    for (int i = 0; i < graph->V; ++i) {                                // For all vertices,
+        int changed = 0;
+
+        for (int u = 0; u < graph->V; ++u)                              // Through edges (grouped by source vertex),
+            for (int j = graph->offsets[u]; j < graph->offsets[u + 1]; ++j)
+                changed |= relax(map, graph, u, j);                     // Relax the Vertices in Map
+
+        if (earlyExit && !changed)                                      // Nothing relaxed, map is final and no negative cycle can exist
+            return 1;
+    }
+
+    map->witness = findNegativeCycle(map, graph);                       // Still can find shorter path, means negative cycle exists
+
+    return map->witness == -1;                                          // Return 0 if negative cycle exists else 1
+}
+
+/*
+ * Bellman Ford - To find shortest path, from
+ * some source to destination vertex
+ *
+ * Returns '0' if negative cycle exists else '1'
+ *
+ * @function int bellmanFord
+ * @param Map *map
+ * @param Graph *graph
+ * @param int src - Index of source vertex
+ * @param int earlyExit - Stop sweeping as soon as a sweep relaxes nothing (1) or always run V sweeps (0)
+ */
+
+int bellmanFord(Map *map, Graph *graph, int src, int earlyExit) {
+
+    initSingleSource(map, graph, src);              // Set up map for give source vertex
+
+    return relaxAll(map, graph, earlyExit);
+}
+
+/*
+ * Shortest Path Faster Algorithm (queue based Bellman Ford) - Only out edges
+ * of vertices whose distance changed are relaxed again
+ *
+ * Each relaxation counts the edges on the new path of a vertex, a path of
+ * V edges repeats some vertex, hence parents of that vertex are checked for
+ * a (negative) cycle
+ *
+ * Returns '0' if negative cycle exists (map->witness leads to it) else '1'
+ *
+ * @function int spfa
+ * @param Map *map
+ * @param Graph *graph
+ * @param int src - Index of source vertex
+ * @param int markInfinity - On negative cycle, mark vertices reachable from it as -∞ and go on (1) or stop (0)
+ */
+
+int spfa(Map *map, Graph *graph, int src, int markInfinity) {
+
+    int V = graph->V, head = 0, size = 0, status = 1;
+    int *queue = (int *) malloc(V * sizeof(int));                       // Circular queue, each vertex is queued at most once at a time
+    char *inQueue = (char *) calloc(V, sizeof(char));                   // Is vertex currently queued
+    int *edgeCount = (int *) calloc(V, sizeof(int));                    // No. of edges on current shortest path of vertex
+    int *seeds = (int *) malloc(V * sizeof(int));                       // Work queue of spreadNegativeInfinity()
+
+    initSingleSource(map, graph, src);              // Set up map for give source vertex
+
+    queue[size++] = src;
+    inQueue[src] = 1;
+
+    while (size > 0 && (status || markInfinity)) {
+        int u = queue[head];                                            // Dequeue
+        head = (head + 1) % V;
+        size--;
+        inQueue[u] = 0;
+
+        for (int j = graph->offsets[u]; j < graph->offsets[u + 1]; ++j) {
+            if (!relax(map, graph, u, j))                               // Distance not improved, nothing to propagate
+                continue;
+
+            int v = graph->targets[j];
+
+            edgeCount[v] = edgeCount[u] + 1;
+
+            if (edgeCount[v] >= V) {                                    // Longer than any simple path, hence parents may hold a negative cycle
+                int x = findParentCycle(map, graph, v);
+
+                if (x != -1) {
+                    if (status)                                         // Report first cycle found
+                        map->witness = x;
+                    status = 0;
+
+                    if (!markInfinity)
+                        break;
+
+                    seeds[0] = x;                                       // Whole cycle and all behind it is -∞, never relaxed again
+                    spreadNegativeInfinity(map, graph, seeds, 1);
+                    continue;
+                }
+            }
+
+            if (!inQueue[v]) {                                          // Enqueue changed vertex to relax its out edges later
+                queue[(head + size) % V] = v;
+                size++;
+                inQueue[v] = 1;
+            }
+        }
+    }
+
+    free(queue);
+    free(inQueue);
+    free(edgeCount);
+    free(seeds);
+
+    return status;
+}
+
+/*
+ * State shared by workers of the parallel engine
+ *
+ * @structure ParallelSweep
+ * @identifier ParallelSweep
+ */
+typedef struct ParallelSweep {
+    Graph *graph;
+    Map *map;
+    int *prev, *next;           // Distances before / after current sweep (swapped after each sweep)
+    int *bounds;                // Worker 'k' owns vertices [bounds[k], bounds[k + 1])
+    int *changed;               // Per worker - did current sweep shorten any distance
+    int threadCount;
+    int anyChanged;             // Did last sweep shorten any distance (any worker)
+    int sweeps;                 // No. of sweeps run
+    pthread_barrier_t barrier;
+} ParallelSweep;
+
+typedef struct ParallelWorker {     // Argument of a worker thread
+    ParallelSweep *sweep;
+    int id;
+} ParallelWorker;
+
+/*
+ * Worker of the parallel engine - Jacobi style sweeps over own vertices,
+ * reading only distances of the previous sweep, hence result does not
+ * depend on thread count or scheduling (parents are left to rebuildParents)
+ *
+ * @function void *parallelSweepWorker
+ * @param void *arg - ParallelWorker
+ */
+
+void *parallelSweepWorker(void *arg) {
+
+    ParallelSweep *sweep = ((ParallelWorker *) arg)->sweep;
+    int id = ((ParallelWorker *) arg)->id;
+    Graph *graph = sweep->graph;
+
+    for (int i = 0; i < graph->V; ++i) {                                // At most V sweeps, V-th one only detects negative cycle
+        int *prev = sweep->prev, *next = sweep->next, changed = 0;
+
+        for (int v = sweep->bounds[id]; v < sweep->bounds[id + 1]; ++v) {
+            int best = prev[v];
+
+            for (int j = graph->inOffsets[v]; j < graph->inOffsets[v + 1]; ++j) {
+                int u = graph->inSources[j];
+
+                if (prev[u] != INT_MAX && prev[u] + graph->inWeights[j] < best)
+                    best = prev[u] + graph->inWeights[j];
+            }
+
+            changed |= (best != prev[v]);
+            next[v] = best;
+        }
+
+        sweep->changed[id] = changed;
+
+        pthread_barrier_wait(&sweep->barrier);                          // Sweep done by everybody
+
+        if (id == 0) {                                                  // Single worker merges flags and swaps buffers
+            sweep->anyChanged = 0;
+            for (int k = 0; k < sweep->threadCount; ++k)
+                sweep->anyChanged |= sweep->changed[k];
+            sweep->prev = next;
+            sweep->next = prev;
+            sweep->sweeps++;
+        }
+
+        pthread_barrier_wait(&sweep->barrier);                          // Merged flags visible to everybody
+
+        if (!sweep->anyChanged)                                         // Map is final
+            break;
+    }
+
+    return NULL;
+}
+
+/*
+ * Parents the serial sweeps (classic / early engines) leave over final
+ * distances. Serial sweeps relax edge in CSR slot 'j' at times j, E + j,
+ * 2E + j..., and a vertex takes as parent the source of the first tight
+ * edge (distance of source + weight = final distance) relaxed after that
+ * source got its own final distance. Vertices are settled in order of that
+ * time (lazy binary heap of candidate edges, like Dijkstra) - O(E log E)
+ *
+ * @function void rebuildParents
+ * @param Map *map - Final distances, parents rebuilt
+ * @param Graph *graph
+ * @param int src - Index of source vertex
+ */
+
+void rebuildParents(Map *map, Graph *graph, int src) {
+
+    long long E = (graph->E > 0) ? graph->E : 1;
+    long long *settled = (long long *) malloc(graph->V * sizeof(long long));   // Time vertex got final distance in serial sweeps, -1 if not settled yet
+    long long *times = (long long *) malloc((graph->E + 1) * sizeof(long long));    // Heap of candidates - time, vertex, parent
+    int *heapVertices = (int *) malloc((graph->E + 1) * sizeof(int));
+    int *heapParents = (int *) malloc((graph->E + 1) * sizeof(int));
+    int size = 0;
+
+    for (int i = 0; i < graph->V; ++i) {
+        map->parents[i] = -1;
+        settled[i] = -1;
+    }
+
+    times[0] = E - 1;                                                   // Source is final before first sweep (time E - 1, just before slot 0 of sweep 1)
+    heapVertices[0] = src;
+    heapParents[0] = -1;
+    size = 1;
+
+    while (size > 0) {
+        long long t = times[0];
+        int u = heapVertices[0], parent = heapParents[0];
+
+        size--;                                                         // Pop least time - sift last candidate down from root
+        if (size > 0) {
+            int i = 0;
+
+            while (2 * i + 1 < size) {
+                int child = 2 * i + 1;
+
+                if (child + 1 < size && times[child + 1] < times[child])
+                    child++;
+                if (times[size] <= times[child])
+                    break;
+                times[i] = times[child];
+                heapVertices[i] = heapVertices[child];
+                heapParents[i] = heapParents[child];
+                i = child;
+            }
+            times[i] = times[size];
+            heapVertices[i] = heapVertices[size];
+            heapParents[i] = heapParents[size];
+        }
+
+        if (settled[u] != -1)                                           // Settled earlier by another edge
+            continue;
+        settled[u] = t;
+        map->parents[u] = parent;
+
+        for (int j = graph->offsets[u]; j < graph->offsets[u + 1]; ++j) {
+            int v = graph->targets[j];
+
+            if (settled[v] != -1 || map->distances[v] != map->distances[u] + graph->weights[j])
+                continue;                                               // Only tight edges to unsettled vertices
+
+            int i = size++;
+            long long at = t + 1 + ((j - t - 1) % E + E) % E;            // First time after 't' that slot 'j' is relaxed
+
+            while (i > 0 && times[(i - 1) / 2] > at) {                  // Sift up
+                times[i] = times[(i - 1) / 2];
+                heapVertices[i] = heapVertices[(i - 1) / 2];
+                heapParents[i] = heapParents[(i - 1) / 2];
+                i = (i - 1) / 2;
+            }
+            times[i] = at;
+            heapVertices[i] = v;
+            heapParents[i] = u;
+        }
+    }
+
+    free(settled);
+    free(times);
+    free(heapVertices);
+    free(heapParents);
+}
+
+/*
+ * Parallel Bellman Ford - Vertices are split across a fixed pool of worker
+ * threads (balanced by in edge count), each sweep relaxes all in edges of
+ * own vertices from distances of previous sweep (double buffered)
+ *
+ * Distances, parents and negative cycle status are same as classic engine -
+ * parents are rebuilt in serial sweep order, and a graph with negative cycle
+ * (whose distances depend on sweep order) is solved again by classic sweeps
+ *
+ * Returns '0' if negative cycle exists (map->witness leads to it) else '1'
+ *
+ * @function int parallelBellmanFord
+ * @param Map *map
+ * @param Graph *graph
+ * @param int src - Index of source vertex
+ * @param int threadCount - No. of worker threads
+ */
+
+int parallelBellmanFord(Map *map, Graph *graph, int src, int threadCount) {
+
+    ParallelSweep sweep;
+    pthread_t *threads;
+    ParallelWorker *workers;
+
+    if (threadCount < 1)
+        threadCount = 1;
+    if (threadCount > graph->V)
+        threadCount = graph->V;
+
+    buildReverseCSR(graph);
+    initSingleSource(map, graph, src);              // Set up map for give source vertex
+
+    sweep.graph = graph;
+    sweep.map = map;
+    sweep.prev = map->distances;
+    sweep.next = (int *) malloc(graph->V * sizeof(int));
+    sweep.bounds = (int *) malloc((threadCount + 1) * sizeof(int));
+    sweep.changed = (int *) calloc(threadCount, sizeof(int));
+    sweep.threadCount = threadCount;
+    sweep.anyChanged = 0;
+    sweep.sweeps = 0;
+    pthread_barrier_init(&sweep.barrier, NULL, threadCount);
+
+    sweep.bounds[0] = 0;                                                // Split vertices so that each worker gets ~E/threadCount in edges
+    for (int k = 1, v = 0; k < threadCount; ++k) {
+        long long target = (long long) graph->E * k / threadCount;
+        while (v < graph->V && graph->inOffsets[v] < target)
+            v++;
+        if (v < sweep.bounds[k - 1] + 1)                                // Every worker owns at least one vertex
+            v = sweep.bounds[k - 1] + 1;
+        if (v > graph->V - (threadCount - k))
+            v = graph->V - (threadCount - k);
+        sweep.bounds[k] = v;
+    }
+    sweep.bounds[threadCount] = graph->V;
+
+    threads = (pthread_t *) malloc(threadCount * sizeof(pthread_t));
+    workers = (ParallelWorker *) malloc(threadCount * sizeof(ParallelWorker));
+
+    for (int k = 1; k < threadCount; ++k) {                             // Calling thread works as worker 0
+        workers[k].sweep = &sweep;
+        workers[k].id = k;
+        pthread_create(&threads[k], NULL, parallelSweepWorker, &workers[k]);
+    }
+    workers[0].sweep = &sweep;
+    workers[0].id = 0;
+    parallelSweepWorker(&workers[0]);
+
+    for (int k = 1; k < threadCount; ++k)
+        pthread_join(threads[k], NULL);
+
+    if (sweep.prev != map->distances)                                   // Latest distances live in scratch buffer
+        memcpy(map->distances, sweep.prev, graph->V * sizeof(int));
+
+    pthread_barrier_destroy(&sweep.barrier);
+    free(map->distances == sweep.prev ? sweep.next : sweep.prev);
+    free(sweep.bounds);
+    free(sweep.changed);
+    free(threads);
+    free(workers);
+
+    if (sweep.sweeps == graph->V && sweep.anyChanged)                   // Still changing in V-th sweep, hence negative cycle exists
+        return bellmanFord(map, graph, src, 0);
+
+    rebuildParents(map, graph, src);
+
+    return 1;
+}
+
+/*
+ * Indexed binary min heap of vertices, keyed by distances in Map
+ *
+ * @structure Heap
+ * @identifier Heap
+ */
+typedef struct Heap {
+    int *vertices;          // Heap ordered vertex indices
+    int *positions;         // Position of vertex in 'vertices', -1 if not in heap
+    int size;               // No. of vertices in heap
+} Heap;
+
+/*
+ * Creates Heap instance able to hold V vertices and returns reference to it
+ *
+ * @function Heap *createHeap
+ * @param int V - No. of Vertices
+ */
+
+Heap *createHeap(int V) {
+
+    Heap *heap = (struct Heap *) malloc(sizeof(struct Heap));
+
+    heap->vertices = (int *) malloc(V * sizeof(int));
+    heap->positions = (int *) malloc(V * sizeof(int));
+    heap->size = 0;
+
+    return heap;
+}
+
+/*
+ * Free Heap instance
+ *
+ * @function void destroyHeap
+ * @param Heap *heap
+ */
+
+void destroyHeap(Heap *heap) {
+
+    free(heap->vertices);
+    free(heap->positions);
+    free(heap);
+}
+
+/*
+ * Move vertex at given heap position up until its parent is not farther
+ *
+ * @function void siftUp
+ * @param Heap *heap
+ * @param int *distances - Keys of vertices
+ * @param int i - Heap position
+ */
+
+void siftUp(Heap *heap, int *distances, int i) {
+
+    int v = heap->vertices[i];
+
+    while (i > 0 && distances[heap->vertices[(i - 1) / 2]] > distances[v]) {
+        heap->vertices[i] = heap->vertices[(i - 1) / 2];                // Pull parent down
+        heap->positions[heap->vertices[i]] = i;
+        i = (i - 1) / 2;
+    }
+
+    heap->vertices[i] = v;
+    heap->positions[v] = i;
+}
+
+/*
+ * Move vertex at given heap position down until no child is nearer
+ *
+ * @function void siftDown
+ * @param Heap *heap
+ * @param int *distances - Keys of vertices
+ * @param int i - Heap position
+ */
+
+void siftDown(Heap *heap, int *distances, int i) {
+
+    int v = heap->vertices[i];
+
+    while (2 * i + 1 < heap->size) {
+        int child = 2 * i + 1;
+
+        if (child + 1 < heap->size && distances[heap->vertices[child + 1]] < distances[heap->vertices[child]])
+            child++;                                                    // Nearer of both children
+
+        if (distances[heap->vertices[child]] >= distances[v])
+            break;
+
+        heap->vertices[i] = heap->vertices[child];                      // Pull child up
+        heap->positions[heap->vertices[i]] = i;
+        i = child;
+    }
+
+    heap->vertices[i] = v;
+    heap->positions[v] = i;
+}
+
+/*
+ * Dijkstra - To find shortest path, from some source to destination vertex,
+ * for graphs without negative edges - O(E log V)
+ *
+ * Returns '1' as no negative cycle can exist
+ *
+ * @function int dijkstra
+ * @param Map *map
+ * @param Graph *graph
+ * @param int src - Index of source vertex
+ * @param Heap *heap - Heap able to hold V vertices (contents are discarded)
+ */
+
+int dijkstra(Map *map, Graph *graph, int src, Heap *heap) {
+
+    initSingleSource(map, graph, src);              // Set up map for give source vertex
+
+    for (int i = 0; i < graph->V; ++i)
+        heap->positions[i] = -1;
+
+    heap->vertices[0] = src;
+    heap->positions[src] = 0;
+    heap->size = 1;
+
+    while (heap->size > 0) {
+        int u = heap->vertices[0];                                      // Extract nearest vertex, its distance is final
+
+        heap->positions[u] = -1;
+        if (--heap->size > 0) {
+            heap->vertices[0] = heap->vertices[heap->size];
+            siftDown(heap, map->distances, 0);
+        }
+
+        for (int j = graph->offsets[u]; j < graph->offsets[u + 1]; ++j) {
+            if (!relax(map, graph, u, j))                               // Distance not improved
+                continue;
+
+            int v = graph->targets[j];
+
+            if (heap->positions[v] == -1) {                             // Insert newly reached vertex
+                heap->vertices[heap->size] = v;
+                siftUp(heap, map->distances, heap->size++);
+            } else                                                      // Decrease key of queued vertex
+                siftUp(heap, map->distances, heap->positions[v]);
+        }
+    }
+
+    return 1;
+}
+
+/*
+ * Report status of solved Map (and negative cycle, if any) in requested format
+ *
+ * @function void reportStatus
+ * @param Report *report
+ * @param Map *map
+ * @param Graph *graph
+ * @param int status - '0' if negative cycle exists else '1'
+ */
+
+void reportStatus(Report *report, Map *map, Graph *graph, int status) {
+
+    Writer *writer = report->writer;
+    int *cycle = (int *) malloc(graph->V * sizeof(int));
+    int length = (status == 0) ? extractNegativeCycle(map, graph, map->witness, cycle) : 0;
+
+    switch (report->format) {
+        case FORMAT_TSV:
+            writeString(writer, "status\t");
+            writeInt(writer, status);
+            writeString(writer, "\n");
+            if (status == 0) {
+                writeString(writer, "cycle");
+                for (int i = 0; i < length; ++i) {
+                    writeString(writer, "\t");
+                    writeString(writer, graph->vertices[cycle[i]].name);
+                }
+                writeString(writer, "\n");
+            }
+            writeString(writer, "source\tvertex\tdistance\tparent\n");
+            break;
+        case FORMAT_BINARY: {
+            int header[] = {status, graph->V, length};
+
+            writeBytes(writer, OUTPUT_MAGIC, 4);
+            writeBytes(writer, header, sizeof(header));
+            writeBytes(writer, cycle, length * sizeof(int));
+            break;
+        }
+        case FORMAT_TABLE:
+        default:
+            writeString(writer, "\n");
+            writeInt(writer, status);                   // Print status
+            if (status == 0)                            // Negative cycle present, show it
+                viewNegativeCycle(writer, graph, cycle, length);
+            break;
+    }
+
+    free(cycle);
+}
+
+/*
+ * Report Map solved from a source vertex in requested format
+ *
+ * @function void reportSource
+ * @param Report *report
+ * @param Map *map
+ * @param Graph *graph
+ * @param int src - Index of source vertex
+ */
+
+void reportSource(Report *report, Map *map, Graph *graph, int src) {
+
+    switch (report->format) {
+        case FORMAT_TSV:
+            viewMapTSV(report->writer, map, graph, src);
+            break;
+        case FORMAT_BINARY:
+            viewMapBinary(report->writer, map, graph, src);
+            break;
+        case FORMAT_TABLE:
+        default:
+            if (report->batch) {                        // Head every source of batch query by its name
+                writeString(report->writer, "\n\nSource: ");
+                writeString(report->writer, graph->vertices[src].name);
+            }
+            viewMap(report->writer, map, graph);                // View Map to vertices from given source
+            viewAllPaths(report->writer, map, graph, src);      // View Paths to all Vertices from given source
+            break;
+    }
+}
+
+/*
+ * Johnson potentials - Bellman Ford from a virtual source joined to every
+ * vertex with '0' weight edges, so that w(u, v) + h(u) - h(v) >= 0 for all edges
+ *
+ * Returns '0' if negative cycle exists (map->witness leads to it) else '1'
+ *
+ * @function int computePotentials
+ * @param Map *map - Result, map->distances holds h(v) of every vertex
+ * @param Graph *graph
+ */
+
+int computePotentials(Map *map, Graph *graph) {
+
+    for (int i = 0; i < graph->V; ++i) {                                // Virtual source reaches everybody with '0' distance
+        map->distances[i] = 0;
+        map->parents[i] = -1;
+    }
+    map->witness = -1;
+
+    return graph->hasNegative ? relaxAll(map, graph, 1) : 1;            // Without negative edges all potentials stay '0'
+}
+
+/*
+ * State shared by workers of a batch query
+ *
+ * @structure BatchQuery
+ * @identifier BatchQuery
+ */
+typedef struct BatchQuery {
+    Graph *graph;                   // Graph as loaded (used for reporting)
+    Graph reweighted;               // Same graph with Johnson reweighted (non negative) edges
+    int *potentials;                // Johnson potentials h(v)
+    int *sources;                   // Source vertex indices to answer, in order
+    int sourceCount;
+    Map **maps;                     // Per worker Map, reused for every source of that worker
+    Heap **heaps;                   // Per worker Heap, reused for every source of that worker
+    int threadCount;
+    void (*report)(Report *, Map *, Graph *, int);  // Called for every source, in given order
+    Report *context;                // First argument of report
+    pthread_barrier_t barrier;
+} BatchQuery;
+
+typedef struct BatchWorker {        // Argument of a worker thread
+    BatchQuery *query;
+    int id;
+} BatchWorker;
+
+/*
+ * Worker of a batch query - Solves every threadCount-th source with Dijkstra
+ * on reweighted edges, worker 0 reports each round in source order
+ *
+ * @function void *batchQueryWorker
+ * @param void *arg - BatchWorker
+ */
+
+void *batchQueryWorker(void *arg) {
+
+    BatchQuery *query = ((BatchWorker *) arg)->query;
+    int id = ((BatchWorker *) arg)->id;
+
+    for (int base = 0; base < query->sourceCount; base += query->threadCount) {
+        int i = base + id;
+
+        if (i < query->sourceCount) {
+            Map *map = query->maps[id];
+            int src = query->sources[i];
+
+            dijkstra(map, &query->reweighted, src, query->heaps[id]);
+
+            for (int v = 0; v < query->graph->V; ++v)                    // Undo reweighting - d(s, v) = d'(s, v) - h(s) + h(v)
+                if (map->distances[v] != INT_MAX)
+                    map->distances[v] += query->potentials[v] - query->potentials[src];
+        }
+
+        pthread_barrier_wait(&query->barrier);                          // Round solved by everybody
+
+        if (id == 0)
+            for (int k = 0; k < query->threadCount && base + k < query->sourceCount; ++k)
+                query->report(query->context, query->maps[k], query->graph, query->sources[base + k]);
+
+        pthread_barrier_wait(&query->barrier);                          // Round reported, Maps free for reuse
+    }
+
+    return NULL;
+}
+
+/*
+ * Johnson - Answer shortest paths from many sources over one loaded graph,
+ * Dijkstra per source (reweighted by given potentials) spread across worker threads
+ *
+ * @function void batchQuery
+ * @param Graph *graph
+ * @param int *potentials - Johnson potentials (from computePotentials)
+ * @param int *sources - Source vertex indices
+ * @param int sourceCount - No. of sources
+ * @param int threadCount - No. of worker threads
+ * @param void (*report)(Report *, Map *, Graph *, int) - Called with Map of every source, in given order
+ * @param Report *context - First argument of report
+ */
+
+void batchQuery(Graph *graph, int *potentials, int *sources, int sourceCount, int threadCount,
+                void (*report)(Report *, Map *, Graph *, int), Report *context) {
+
+    BatchQuery query;
+    pthread_t *threads;
+    BatchWorker *workers;
+
+    if (threadCount > sourceCount)
+        threadCount = sourceCount;
+    if (threadCount < 1)
+        threadCount = 1;
+
+    query.graph = graph;
+    query.reweighted = *graph;
+    query.reweighted.weights = (int *) malloc(graph->E * sizeof(int));
+    query.potentials = potentials;
+    query.sources = sources;
+    query.sourceCount = sourceCount;
+    query.threadCount = threadCount;
+    query.report = report;
+    query.context = context;
+    pthread_barrier_init(&query.barrier, NULL, threadCount);
+
+    for (int u = 0; u < graph->V; ++u)                                  // w'(u, v) = w(u, v) + h(u) - h(v)
+        for (int j = graph->offsets[u]; j < graph->offsets[u + 1]; ++j)
+            query.reweighted.weights[j] = graph->weights[j] + potentials[u] - potentials[graph->targets[j]];
+
+    query.maps = (Map **) malloc(threadCount * sizeof(Map *));
+    query.heaps = (Heap **) malloc(threadCount * sizeof(Heap *));
+    for (int k = 0; k < threadCount; ++k) {                             // Preallocated once, reused for every source
+        query.maps[k] = createMap(graph->V);
+        query.heaps[k] = createHeap(graph->V);
+    }
+
+    threads = (pthread_t *) malloc(threadCount * sizeof(pthread_t));
+    workers = (BatchWorker *) malloc(threadCount * sizeof(BatchWorker));
+
+    for (int k = 1; k < threadCount; ++k) {                             // Calling thread works as worker 0
+        workers[k].query = &query;
+        workers[k].id = k;
+        pthread_create(&threads[k], NULL, batchQueryWorker, &workers[k]);
+    }
+    workers[0].query = &query;
+    workers[0].id = 0;
+    batchQueryWorker(&workers[0]);
+
+    for (int k = 1; k < threadCount; ++k)
+        pthread_join(threads[k], NULL);
+
+    for (int k = 0; k < threadCount; ++k) {
+        destroyMap(query.maps[k]);
+        destroyHeap(query.heaps[k]);
+    }
+
+    pthread_barrier_destroy(&query.barrier);
+    free(query.reweighted.weights);
+    free(query.maps);
+    free(query.heaps);
+    free(threads);
+    free(workers);
+}
+
+/*
+ * Solve Map for given source with the requested relaxation engine
+ *
+ * Returns '0' if negative cycle exists else '1'
+ *
+ * @function int solve
+ * @param Map *map
+ * @param Graph *graph
+ * @param int src - Index of source vertex
+ * @param Engine engine - Relaxation engine to use
+ * @param int threadCount - No. of worker threads (parallel engine only)
+ * @param int markInfinity - On negative cycle, still solve Map with vertices reachable from it as -∞ (1) or not (0)
+ */
+
+int solve(Map *map, Graph *graph, int src, Engine engine, int threadCount, int markInfinity) {
+
+    int status;
+
+    if (engine == ENGINE_AUTO)                                          // Dijkstra is exact only without negative edges
+        engine = graph->hasNegative ? ENGINE_CLASSIC : ENGINE_DIJKSTRA;
+
+    switch (engine) {
+        case ENGINE_EARLY:
+            status = bellmanFord(map, graph, src, 1);
+            break;
+        case ENGINE_SPFA:
+            return spfa(map, graph, src, markInfinity);                 // Marks -∞ while solving
+        case ENGINE_PARALLEL:
+            status = parallelBellmanFord(map, graph, src, threadCount);
+            break;
+        case ENGINE_DIJKSTRA: {
+            Heap *heap = createHeap(graph->V);
+            status = dijkstra(map, graph, src, heap);
+            destroyHeap(heap);
+            break;
+        }
+        case ENGINE_CLASSIC:
+        default:
+            status = bellmanFord(map, graph, src, 0);
+            break;
+    }
+
+    if (status == 0 && markInfinity)                                    // Sweep engines leave final distances everywhere else
+        markNegativeInfinity(map, graph);
+
+    return status;
+}
+
+/*
+ * Find Engine by its name (as in engineNames)
+ *
+ * Returns -1 if no such engine
+ *
+ * @function int getEngineByName
+ * @param char *name
+ */
+
+int getEngineByName(char *name) {
+
+    for (int i = 0; i < (int) (sizeof(engineNames) / sizeof(engineNames[0])); ++i)
+        if (strcmp(engineNames[i], name) == 0)
+            return i;
+
+    return -1;
+}
+
+/*
+ * Find OutputFormat by its name (as in formatNames)
+ *
+ * Returns -1 if no such format
+ *
+ * @function int getFormatByName
+ * @param char *name
+ */
+
+int getFormatByName(char *name) {
+
+    for (int i = 0; i < (int) (sizeof(formatNames) / sizeof(formatNames[0])); ++i)
+        if (strcmp(formatNames[i], name) == 0)
+            return i;
+
+    return -1;
+}
+
+/*
+ * Start of Execution
+ */
+
+int main(int argc, char *argv[]) {
+
+    /*
+     * Prerequisites
+     */
+    int opt;
+    Engine engine = ENGINE_AUTO;
+    int threadCount = (int) sysconf(_SC_NPROCESSORS_ONLN);      // Default - one worker per online core
+    Map *map;
+    Graph *graph;
+    int src;
+    char *sourceList = NULL;                // Batch query sources ("-s"), NULL for single source mode
+    int *sources, sourceCount;
+    char *snapshotPath = NULL;              // Binary snapshot to load ("-b"), NULL to read text input
+    char *convertPath = NULL;               // Binary snapshot to write ("-c"), NULL to solve
+    int markInfinity = 0;                   // On negative cycle, still solve with -∞ distances ("-n")
+    Report report = {NULL, FORMAT_TABLE, 0};
+
+    while ((opt = getopt(argc, argv, "e:t:s:b:c:no:")) != -1) {            // Accept options
+        switch (opt) {
+            case 'e':                                           // Relaxation engine
+                if (getEngineByName(optarg) == -1) {
+                    fprintf(stderr, "Unknown engine '%s'\n", optarg);
+                    return 1;
+                }
+                engine = (Engine) getEngineByName(optarg);
+                break;
+            case 't':                                           // Worker threads of parallel engine / batch query
+                threadCount = atoi(optarg);
+                break;
+            case 's':                                           // Batch query sources
+                sourceList = optarg;
+                break;
+            case 'b':                                           // Load binary snapshot instead of text input
+                snapshotPath = optarg;
+                break;
+            case 'c':                                           // Convert text input to binary snapshot
+                convertPath = optarg;
+                break;
+            case 'n':                                           // Keep solving past negative cycles
+                markInfinity = 1;
+                break;
+            case 'o':                                           // Output format
+                if (getFormatByName(optarg) == -1) {
+                    fprintf(stderr, "Unknown output format '%s'\n", optarg);
+                    return 1;
+                }
+                report.format = (OutputFormat) getFormatByName(optarg);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-e auto|classic|early|spfa|parallel|dijkstra] [-t threads] [-s all|name[,name...]] [-n] [-o table|tsv|bin] [-b snapshot | -c snapshot]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    if (sourceList != NULL && (engine != ENGINE_AUTO || markInfinity)) {  // Batch query always runs Johnson, and stops at negative cycle
+        fprintf(stderr, "Options -e and -n do not apply to batch query (-s)\n");
+        return 1;
+    }
+
+    graph = (snapshotPath != NULL) ? loadSnapshot(snapshotPath) : readGraph();     // Set up Graph
+    if (graph == NULL)
+        return 1;
+
+    if (convertPath != NULL) {                      // Only convert text input to snapshot
+        int written = writeSnapshot(graph, convertPath);
+        destroyGraph(graph);
+        return written ? 0 : 1;
+    }
+
+    map = createMap(graph->V);                      // Set up Map
+    report.writer = createWriter(STDOUT_FILENO, WRITER_SIZE);  // Set up buffered output
+    report.batch = (sourceList != NULL);
+
+    if (engine == ENGINE_DIJKSTRA && graph->hasNegative)
+        fprintf(stderr, "Warning - graph has negative edges, dijkstra may give wrong distances\n");
+
+    if (sourceList != NULL) {                       // Batch query - Johnson, all given sources over this one graph
+        if ((sourceCount = parseSources(graph, sourceList, &sources)) == -1)
+            return 1;
+
+        int status = computePotentials(map, graph);    // Single Bellman Ford for all sources
+
+        reportStatus(&report, map, graph, status);  // Print status (or the cycle that makes potentials impossible)
+
+        if (status == 1)                            // Is no negative cycle present
+            batchQuery(graph, map->distances, sources, sourceCount, threadCount, reportSource, &report);
+
+        destroyWriter(report.writer);
+        free(sources);
+        destroyMap(map);
+        destroyGraph(graph);
+
+        return 0;
+    }
+
+    src = 0;                                        // Currently default source vertex set to 1st vertex
+
+    int status = solve(map, graph, src, engine, threadCount, markInfinity);    // Receive status of Bellman Ford Algorithm for given source
+
+    reportStatus(&report, map, graph, status);      // Print status (and negative cycle, if present)
+
+    if (status == 1 || markInfinity)                // Is no negative cycle present (or solved around it)
+        reportSource(&report, map, graph, src);     // View Map and Paths to all Vertices from given source
+
+    destroyWriter(report.writer);                   // Write out buffered output
+    destroyMap(map);
+    destroyGraph(graph);
+
+    return 0;       // End of line
+
+}
+
+/*
+ * USAGE
+ *
+ * gcc -O2 -pthread prog.c -o prog
+ * prog [-e auto|classic|early|spfa|parallel|dijkstra] [-t threads] [-s all|name[,name...]] [-n] [-o table|tsv|bin] < input
+ * prog [-e ...] [-t threads] [-s ...] -b snapshot
+ * prog -c snapshot < input
+ *
+ *  -e  Relaxation engine (default auto)
+ *          auto     - dijkstra if no edge has negative weight, else classic
+ *          classic  - V full sweeps over all edges
+ *          early    - Full sweeps, stopped as soon as a sweep relaxes nothing
+ *          spfa     - Queue based, only out edges of vertices whose distance changed are relaxed again
+ *          parallel - Double buffered sweeps over in edges, vertices split across worker threads
+ *          dijkstra - Binary heap Dijkstra (forced even with negative edges - distances may then be wrong)
+ *  -t  No. of worker threads for parallel engine and batch query (default - online cores)
+ *  -s  Batch query - answer all given source vertices (or "all") in one run, Johnson's algorithm
+ *      (one Bellman Ford for potentials, then Dijkstra per source on reweighted edges across threads)
+ *      (engine is fixed, hence not combined with -e or -n)
+ *  -n  On negative cycle, still show map and paths - vertices reachable from a cycle get -∞ distance
+ *  -o  Output format (default table)
+ *          table - Map and routes as shown in OUTPUT FORMAT
+ *          tsv   - "status\t(status)", ["cycle\t(v. name)..."], then "(source)\t(vertex)\t(distance)\t(parent)" rows,
+ *                  distance 'inf' if unreachable, '-inf' behind negative cycle, parent '-' if none
+ *          bin   - "BFMR", int status, int V, int cycle length, int cycle[], then per source -
+ *                  int source, int distances[V], int parents[V] (INT_MAX unreachable, INT_MIN -∞, -1 no parent)
+ *  -c  Convert text input to binary snapshot file (CSR arrays, name index, name table) and exit
+ *  -b  Solve over binary snapshot file (mapped into memory, no parsing) instead of text input
+ *
+ */
+
+/*
+ * INPUT FORMAT
+ *
+ * (vertex count) (edges count)
+ * (vertex name) [(vertex name)...]
+ * ((source vertex name) (destination vertex name) (weight)) [((source vertex name) (destination vertex name) (weight))...]
+ *
+ */
+
+/*
+ * OUTPUT FORMAT
+ *
+ * (bellman ford status)
+ *
+ * <if status = 0>{
+ *      Negative cycle: (v. name) => [(v. name) =>...] (first v. name again)
+ *      <if -n>{ (map) (paths to destination vertices) - '-∞' distance, '-' route behind cycle }
+ * }
+ *
+ * <if batch query, status = 1>{
+ *      (source){
+ *          Source: (source v. name)
+ *          (map)
+ *          (paths to destination vertices)
+ *      }
+ *      [(source)...]
+ * }
  *
  * <if status = 1>{
  *      (map){
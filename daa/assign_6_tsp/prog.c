@@ -5,228 +5,2830 @@
  * some source to destination in a Graph
  */
 
+#include <ctype.h>
 #include <limits.h>
+#include <stddef.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sched.h>
+#include <pthread.h>
+#include <time.h>
+#include <math.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_KERNELS    // Build SSE4.1 / AVX2 kernels, picked at run time if CPU supports them
+#endif
 
-#define MAX 50              // Haystack Max size, any array
+#define MATRIX_MAGIC "TSPM" // First bytes of a binary matrix file
+#define MATRIX_VERSION 1    // Layout version of binary matrix file
+#define POOL_SLAB_NODES 256 // Nodes carved out of every slab of a NodePool
+#define COMPACT_INF 0xFFFF  // Infinity in a compact (unsigned short) matrix cell
+#define HELD_KARP_MAX 20    // Auto engine solves up to this many vertices with Held-Karp (table of 2^(n-1) * (n-1) ints - 40MB at 20)
+#define HELD_KARP_LIMIT 24  // Held-Karp is refused beyond this many vertices, even if asked for (table would exceed ~770MB)
+#define HELD_KARP_BLOCK 1024    // Subsets handed to a Held-Karp worker at a time
+#define NEIGHBOUR_K 8       // Candidate next vertices per vertex tried by local search
+#define ARC_INF (1LL << 40) // Weight of missing edge in local search sums (never part of an improving move)
+#define HEURISTIC_EXACT_MAX 9   // Approximate engine tries every route up to this many vertices (8! orders at most)
+#define HEURISTIC_SEED 2463534242u   // Default seed of random kicks (see '-r')
+#define KICK_ENUMERATE_MAX 40   // Up to this many vertices kicks walk through every set of double bridge cuts, beyond they are random
+#define ONE_TREE_ROOT_ITERATIONS 200    // Subgradient steps of 1-tree bound at root node
+#define ONE_TREE_CHILD_ITERATIONS 12    // Subgradient steps of 1-tree bound at other nodes (warm started from parent)
+#define COORD_LIMIT 1e8    // Coordinates are refused beyond this magnitude, so every distance fits an int
+#define BOUND_COUNT 2       // Lower bounds in bounds[] - a search keeps data and scratches of each
+
+typedef enum Engine {       // Exact solver
+    ENGINE_AUTO,            // Held-Karp up to HELD_KARP_MAX vertices, branch and bound beyond
+    ENGINE_BRANCH_BOUND,    // Best first branch and bound (bound as per Options)
+    ENGINE_HELD_KARP,       // Bitmask dynamic programming over subsets
+    ENGINE_APPROXIMATE      // Heuristic only - best route found within time budget, not necessarily optimal
+} Engine;
+
+const char *engineNames[] = {"auto", "bnb", "heldkarp", "approx"};    // Names accepted by '-e' option (indexed by Engine)
+
+typedef struct Options {    // Run time options (set from command line)
+    Engine engine;
+    int threadCount;        // No. of worker threads
+    int budgetMs;           // Time budget of approximate engine (milliseconds)
+    const struct Bound *bound;  // Lower bound of branch and bound, NULL - picked per instance
+    int deadlineMs;         // Wall clock limit of search (milliseconds since start), 0 - none
+    int progressMs;         // Interval of progress lines on stderr (milliseconds), 0 - none
+    int anytime;            // Print every improved route as soon as it is found
+    int stats;              // Dump statistics of run (JSON) on stderr
+    unsigned seed;          // Seed of random kicks of heuristic
+} Options;
+
+Options options = {ENGINE_AUTO, 1, 100, NULL, 0, 0, 0, 0, HEURISTIC_SEED};
+
+/*
+ * Statistics of a run - filled in by TSP(), counters only by branch and bound
+ * (start and deadline set up by resetStats() before it is called)
+ *
+ * @structure RunStats
+ * @identifier RunStats
+ */
+typedef struct RunStats {
+    const char *engine;             // Engine actually run
+    const char *bound;              // Lower bound of branch and bound (NULL if not run)
+    double start;                   // clockSeconds() at start of run
+    double deadline;                // clockSeconds() search is stopped at (INFINITY - none)
+    double seconds;                 // Wall clock time of TSP()
+    long long expanded;             // Nodes expanded
+    long long generated;            // Children pushed as live nodes
+    long long pruned;               // Nodes and children dropped for not beating incumbent
+    long long routes;               // Complete routes evaluated
+    long long boundNanos;           // Time spent evaluating bounds of children (summed over workers)
+    int incumbents;                 // Improved routes found (seed included)
+    int best;                       // Cost of best route (INT_MAX - none)
+    int lowerBound;                 // Least bound no route can beat (equals best once search is complete)
+    int stopped;                    // Search was cut short by deadline or signal, best is not proven optimal
+} RunStats;
+
+volatile sig_atomic_t stopRequested = 0;    // Set by SIGINT / SIGTERM or deadline - search ends, keeping best route so far
+
+typedef struct SearchCounters {     // Counters of a branch and bound worker (written by owner only, read by progress reports)
+    long long expanded, generated, pruned, routes, boundNanos;
+} SearchCounters;
+
+/*
+ * Problem instance - either a full weight matrix (parsed or mapped from a binary
+ * matrix file) or coordinates of points, weights being computed on demand
+ *
+ * @structure Instance
+ * @identifier Instance
+ */
+typedef struct Instance {
+    int n;                          // Amount of vertices
+    int src;                        // Source vertex (as given by input)
+    int *mat;                       // n x n weights row wise, [i][i] infinite (NULL in coordinate mode)
+    double *x, *y;                  // Coordinates of vertices (coordinate mode), weight - rounded Euclidean distance
+    void *mapping;                  // Mapped binary matrix file mat points into (NULL if parsed)
+    size_t mappingSize;
+    int capacity;                   // Vertices mat (or x, y) has room for - next instance parsed into it reuses storage
+} Instance;
+
+/*
+ * Header of binary matrix file, followed by n * n int weights row wise
+ * (INT_MAX - no edge, also on diagonal)
+ *
+ * @structure MatrixHeader
+ * @identifier MatrixHeader
+ */
+typedef struct MatrixHeader {
+    char magic[4];                  // MATRIX_MAGIC
+    int version;                    // MATRIX_VERSION
+    int n;                          // Amount of vertices
+    int src;                        // Source vertex (0 based)
+} MatrixHeader;
+
+/*
+ * Live node of branch and bound search - a partial route from source
+ * with its lower bound and state of the bound it was derived with
+ *
+ * @structure Node
+ * @identifier Node
+ */
+typedef struct Node {
+    struct Node *next;              // Next free node of pool (only while free)
+    int pathCount;                  // Amount of vertices in relative path
+    int cost;                       // Lower bound "C(S)" of any route through this node
+    int data[];                     // Relative path/tree of vertex connections (n slots, starts at source), then
+                                    // state of bound (see Bound)
+} Node;
+
+/*
+ * Per worker allocator of nodes - nodes (all of one size) are carved out of
+ * slabs and recycled through a free list, slabs are released all at once
+ *
+ * @structure NodePool
+ * @identifier NodePool
+ */
+typedef struct NodePool {
+    size_t nodeSize;                // Bytes per node, header, path and bound state
+    size_t slabNodeSize;            // Node size slabs were allocated for (a reset pool reuses them for nodes no bigger)
+    Node *freeList;                 // Released nodes, reused before carving new ones
+    char **slabs;                   // Every slab allocated so far
+    int slabCount, slabCapacity;
+    int slabCurrent;                // Slab being carved
+    int slabUsed;                   // Nodes carved out of current slab
+} NodePool;
+
+/*
+ * Min heap of live nodes, ordered by lower bound (deeper node first on tie)
+ *
+ * @structure NodeHeap
+ * @identifier NodeHeap
+ */
+typedef struct NodeHeap {
+    Node **nodes;
+    int size, capacity;
+} NodeHeap;
+
+typedef struct BoundCache {         // Data and scratches of a bound, kept while searches use another one
+    void *data;                     // Shared data of bound (NULL until first set up, then reused while n fits)
+    void **scratches;               // Per worker working memory of bound (NULL until first created, reused likewise)
+    int capacity;                   // Vertices data and scratches have room for
+} BoundCache;
+
+/*
+ * Shared state of a parallel branch and bound search - every worker owns a heap
+ * of live nodes (best first locally) and steals from the others when it runs dry.
+ * Kept by a Solver from one search to the next, so heaps, pools, bound data and
+ * scratches are allocated once and only grown
+ *
+ * @structure Search
+ * @identifier Search
+ */
+typedef struct Search {
+    Instance *instance;             // Original matrix (complete routes are costed over it)
+    int n;                          // Amount of elements in haystack
+    int threadCount;
+    NodeHeap *heaps;                // Per worker heap of live nodes
+    NodePool *pools;                // Per worker node allocator (a stolen node is released to the thief's pool)
+    pthread_mutex_t *locks;         // locks[k] guards heaps[k]
+    int best;                       // Cost of best complete route (incumbent) - read by everybody for pruning, written under incumbentLock
+    int *bestRoute;                 // Vertices of incumbent in visiting order
+    pthread_mutex_t incumbentLock;
+    long outstanding;               // Live nodes in all heaps plus nodes being expanded - search is over once it drops to 0
+    const struct Bound *bound;      // Lower bound of nodes
+    BoundCache *cache;              // Data and scratches of bound (one of caches)
+    BoundCache caches[BOUND_COUNT]; // Of every bound in bounds[], so switching bound from one search to next allocates nothing
+    SearchCounters *counters;       // Per worker
+    RunStats *stats;                // Of solver running the search
+    int stop;                       // Deadline passed - search ends (like stopRequested, for this search only)
+    double nextProgress;            // clockSeconds() of next progress line
+} Search;
+
+/*
+ * Lower bound of branch and bound nodes - every node carries a state of the bound
+ * (reduced matrix, penalties...) right after its path, from which the bound of each
+ * child is derived. A worker loads a node, evaluates each child through its own
+ * scratch and stores the state of those that survive
+ *
+ * @structure Bound
+ * @identifier Bound
+ */
+typedef struct Bound {
+    const char *name;                                           // Name accepted by '-B' option
+    size_t (*setup)(Search *search, int src);                   // Set up search->cache->data (allocated if NULL, else reused), returns bytes of state per node
+    void (*cleanup)(Search *search);                            // Release search->cache->data
+    void *(*createScratch)(Search *search);                     // Working memory of a worker
+    void (*destroyScratch)(void *scratch);
+    int (*root)(Search *search, void *scratch, int src);        // Bound of root node (source only), its state left in scratch
+    void (*load)(Search *search, void *scratch, Node *node);    // Take up node as parent of following evaluate() calls
+    int (*evaluate)(Search *search, void *scratch, Node *node, int dest);   // Bound of child through dest (INT_MAX if no such child), its state left in scratch
+    void (*store)(Search *search, void *scratch, Node *child);  // Save state left in scratch into child
+} Bound;
+
+typedef struct ReduceData {         // Shared data of reduction bound
+    int compact;                    // Are cells stored as unsigned short (COMPACT_INF - infinity)
+    int *rootMat;                   // Reduced matrix of root node
+    int rootCost;
+} ReduceData;
+
+typedef struct ReduceScratch {      // Working matrices of a worker, nodes hold compact copies
+    int *parentMat, *childMat;
+} ReduceScratch;
+
+typedef struct OneTreeData {        // Shared data of 1-tree bound
+    int *sym;                       // sym[i * n + j] = min(c[i][j], c[j][i]) - tree edges are priced symmetric
+} OneTreeData;
+
+typedef struct OneTreeState {       // Per node state of 1-tree bound
+    int pathCost;                   // Exact cost of node's path
+    float pi[];                     // Penalty of every vertex (n), warm start of children
+} OneTreeState;
+
+typedef struct OneTreeScratch {     // Working memory of a worker
+    char *visited;                  // Vertices on path of loaded node
+    int *rest;                      // Vertices off path of child being evaluated
+    int restCount;
+    double *pi, *bestPi;            // Penalties being optimised (by vertex), penalties of best bound so far
+    double *key;                    // Prim - cheapest link of every rest position into tree
+    char *done;                     // Prim - rest position is in tree
+    int *link, *degree;             // Prim - tree neighbour, degree of every rest position
+    int pathCost;                   // Path cost of child being evaluated
+    OneTreeState *parent;           // State of loaded node
+} OneTreeScratch;
+
+/*
+ * Row kernels used by matrix reduction - every one leaves infinite (INT_MAX) cells untouched
+ *
+ * @structure Kernels
+ * @identifier Kernels
+ */
+typedef struct Kernels {
+    const char *name;                                   // Name accepted by '-k' option
+    int (*rowMin)(const int *row, int n);               // Min of row
+    void (*minInto)(int *acc, const int *row, int n);   // acc[j] = min(acc[j], row[j]) - column mins in row major order
+    void (*subtractRow)(int *row, int r, int n);        // row[j] -= r
+    void (*subtractEach)(int *row, const int *sub, int n);  // row[j] -= sub[j]
+} Kernels;
+
+typedef struct SearchWorker {       // Argument of a worker thread
+    Search *search;
+    int id;
+    char *visited;                  // Vertices on path of node being expanded (solver capacity)
+    int *route;                     // Complete route being costed (solver capacity)
+} SearchWorker;
+
+typedef struct RouteScratch {       // Working memory of heuristic (solver capacity)
+    int *pos;                       // Position of every vertex on route
+    long long *forward, *backward;  // Prefix sums of route walked forwards / backwards (capacity + 1)
+    int *moved;                     // Route being rebuilt by Or-opt or kicked by double bridge
+    char *visited;                  // Vertices already on nearest neighbour route
+} RouteScratch;
+
+/*
+ * Shared state of Held-Karp - source fixed, subsets over the other m vertices.
+ * dp[mask * m + last] - least cost of leaving source, visiting exactly the vertices of
+ * mask and ending at last (in mask), so all end vertices of a subset are adjacent in memory
+ *
+ * @structure HeldKarp
+ * @identifier HeldKarp
+ */
+typedef struct HeldKarp {
+    int m;                          // Vertices other than source
+    int others[HELD_KARP_LIMIT];    // Vertex of every bit position
+    int in[HELD_KARP_LIMIT][HELD_KARP_LIMIT];   // in[last][prev] - weight of edge others[prev] -> others[last] (row wise for inner loop)
+    int *dp;                        // 2^m * m table
+    int threadCount;
+    pthread_barrier_t barrier;      // Layers (subset sizes) are done one after other
+} HeldKarp;
+
+typedef struct HeldKarpWorker {     // Argument of a worker thread
+    HeldKarp *dp;
+    int id;
+} HeldKarpWorker;
+
+/*
+ * Reusable context of TSP() - everything a solve needs besides the instance itself,
+ * kept from one instance to the next and only grown when a bigger one comes along.
+ * Batch mode gives each of its worker threads a solver of its own
+ *
+ * @structure Solver
+ * @identifier Solver
+ */
+typedef struct Solver {
+    int threadCount;                // Workers of branch and bound / Held-Karp within an instance
+    unsigned stream;                // Mixed into seed of heuristic - no. of instance in batch mode, 0 otherwise
+    RunStats stats;                 // Of last instance solved
+    int capacity;                   // Vertices buffers below have room for
+    int *route;                     // Best route in visiting order
+    int *kick;                      // Working route of heuristic
+    int *current;                   // Route kicks of heuristic start from
+    int *neighbours;                // Candidate lists of heuristic (NEIGHBOUR_K per vertex)
+    RouteScratch scratch;           // Working memory of heuristic
+    int *dense;                     // Full matrix of a coordinate instance
+    int denseCapacity;              // Vertices dense has room for
+    Search search;                  // Heaps, pools, locks and bound data of branch and bound
+    HeldKarp heldKarp;
+    size_t heldKarpCells;           // Cells heldKarp.dp has room for
+    pthread_t *threads;             // threadCount - shared by branch and bound and Held-Karp
+    SearchWorker *searchWorkers;
+    HeldKarpWorker *heldKarpWorkers;
+} Solver;
+
+typedef struct Batch {              // Shared state of batch mode
+    char *cursor;                   // Rest of input, next instance
+    int points;                     // Instances hold coordinates
+    long nextInput;                 // Sequence no. of next instance handed out
+    long nextOutput;                // Sequence no. of next result to be printed
+    const char *error;              // Why handing out stopped early (NULL - it didn't)
+    char errorText[64];
+    long errorAt;                   // Sequence no. of instance error is about
+    pthread_mutex_t inputLock, outputLock;
+    pthread_cond_t turn;            // Broadcast whenever nextOutput moves on
+} Batch;
+
+typedef struct BatchWorker {        // Argument of a batch worker thread
+    Batch *batch;
+    Solver solver;
+    Instance *instance;             // Storage every instance of this worker is parsed into
+    int *path;
+    int pathCapacity;
+} BatchWorker;
+
+/*
+ * Copy one matrix to other - backup
+ *
+ * @function void copy
+ * @param int *res - Destination matrix (n x n row wise)
+ * @param int *mat - Source matrix (n x n row wise)
+ * @param int n - Amount of elements in haystack
+ */
+
+void copy(int *res, int *mat, int n) {
+    memcpy(res, mat, (size_t) n * n * sizeof(int));
+}
+
+/*
+ * Scalar kernels - portable fallback
+ */
+
+int rowMinScalar(const int *row, int n) {
+    int min = INT_MAX;
+    for (int j = 0; j < n; ++j)
+        if (row[j] < min)
+            min = row[j];
+    return min;
+}
+
+void minIntoScalar(int *acc, const int *row, int n) {
+    for (int j = 0; j < n; ++j)
+        if (row[j] < acc[j])
+            acc[j] = row[j];
+}
+
+void subtractRowScalar(int *row, int r, int n) {
+    for (int j = 0; j < n; ++j)
+        if (row[j] != INT_MAX)                          // If infinite value, no need to subtract
+            row[j] -= r;
+}
+
+void subtractEachScalar(int *row, const int *sub, int n) {
+    for (int j = 0; j < n; ++j)
+        if (row[j] != INT_MAX)                          // If infinite value, no need to subtract
+            row[j] -= sub[j];
+}
+
+#ifdef HAVE_X86_KERNELS
+
+/*
+ * SSE4.1 kernels - 4 cells at a time, infinity kept by blending original cell back
+ */
+
+__attribute__((target("sse4.1")))
+int rowMinSSE41(const int *row, int n) {
+    __m128i acc = _mm_set1_epi32(INT_MAX);
+    int j = 0, min;
+
+    for (; j + 4 <= n; j += 4)
+        acc = _mm_min_epi32(acc, _mm_loadu_si128((const __m128i *) (row + j)));
+    acc = _mm_min_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+    acc = _mm_min_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+    min = _mm_cvtsi128_si32(acc);
+
+    for (; j < n; ++j)                                  // Tail
+        if (row[j] < min)
+            min = row[j];
+    return min;
+}
+
+__attribute__((target("sse4.1")))
+void minIntoSSE41(int *acc, const int *row, int n) {
+    int j = 0;
+
+    for (; j + 4 <= n; j += 4) {
+        __m128i a = _mm_loadu_si128((const __m128i *) (acc + j));
+        _mm_storeu_si128((__m128i *) (acc + j), _mm_min_epi32(a, _mm_loadu_si128((const __m128i *) (row + j))));
+    }
+    for (; j < n; ++j)
+        if (row[j] < acc[j])
+            acc[j] = row[j];
+}
+
+__attribute__((target("sse4.1")))
+void subtractRowSSE41(int *row, int r, int n) {
+    __m128i inf = _mm_set1_epi32(INT_MAX), sub = _mm_set1_epi32(r);
+    int j = 0;
+
+    for (; j + 4 <= n; j += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i *) (row + j));
+        _mm_storeu_si128((__m128i *) (row + j), _mm_blendv_epi8(_mm_sub_epi32(v, sub), v, _mm_cmpeq_epi32(v, inf)));
+    }
+    subtractRowScalar(row + j, r, n - j);
+}
+
+__attribute__((target("sse4.1")))
+void subtractEachSSE41(int *row, const int *sub, int n) {
+    __m128i inf = _mm_set1_epi32(INT_MAX);
+    int j = 0;
+
+    for (; j + 4 <= n; j += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i *) (row + j));
+        __m128i d = _mm_sub_epi32(v, _mm_loadu_si128((const __m128i *) (sub + j)));
+        _mm_storeu_si128((__m128i *) (row + j), _mm_blendv_epi8(d, v, _mm_cmpeq_epi32(v, inf)));
+    }
+    subtractEachScalar(row + j, sub + j, n - j);
+}
+
+/*
+ * AVX2 kernels - 8 cells at a time, infinity kept by blending original cell back
+ */
+
+__attribute__((target("avx2")))
+int rowMinAVX2(const int *row, int n) {
+    __m256i acc = _mm256_set1_epi32(INT_MAX);
+    __m128i half;
+    int j = 0, min;
+
+    for (; j + 8 <= n; j += 8)
+        acc = _mm256_min_epi32(acc, _mm256_loadu_si256((const __m256i *) (row + j)));
+    half = _mm_min_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    half = _mm_min_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+    half = _mm_min_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+    min = _mm_cvtsi128_si32(half);
+
+    for (; j < n; ++j)                                  // Tail
+        if (row[j] < min)
+            min = row[j];
+    return min;
+}
+
+__attribute__((target("avx2")))
+void minIntoAVX2(int *acc, const int *row, int n) {
+    int j = 0;
+
+    for (; j + 8 <= n; j += 8) {
+        __m256i a = _mm256_loadu_si256((const __m256i *) (acc + j));
+        _mm256_storeu_si256((__m256i *) (acc + j), _mm256_min_epi32(a, _mm256_loadu_si256((const __m256i *) (row + j))));
+    }
+    for (; j < n; ++j)
+        if (row[j] < acc[j])
+            acc[j] = row[j];
+}
+
+__attribute__((target("avx2")))
+void subtractRowAVX2(int *row, int r, int n) {
+    __m256i inf = _mm256_set1_epi32(INT_MAX), sub = _mm256_set1_epi32(r);
+    int j = 0;
+
+    for (; j + 8 <= n; j += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i *) (row + j));
+        _mm256_storeu_si256((__m256i *) (row + j), _mm256_blendv_epi8(_mm256_sub_epi32(v, sub), v, _mm256_cmpeq_epi32(v, inf)));
+    }
+    subtractRowScalar(row + j, r, n - j);
+}
+
+__attribute__((target("avx2")))
+void subtractEachAVX2(int *row, const int *sub, int n) {
+    __m256i inf = _mm256_set1_epi32(INT_MAX);
+    int j = 0;
+
+    for (; j + 8 <= n; j += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i *) (row + j));
+        __m256i d = _mm256_sub_epi32(v, _mm256_loadu_si256((const __m256i *) (sub + j)));
+        _mm256_storeu_si256((__m256i *) (row + j), _mm256_blendv_epi8(d, v, _mm256_cmpeq_epi32(v, inf)));
+    }
+    subtractEachScalar(row + j, sub + j, n - j);
+}
+
+#endif
+
+const Kernels kernelSets[] = {                          // Best first
+#ifdef HAVE_X86_KERNELS
+    {"avx2", rowMinAVX2, minIntoAVX2, subtractRowAVX2, subtractEachAVX2},
+    {"sse4.1", rowMinSSE41, minIntoSSE41, subtractRowSSE41, subtractEachSSE41},
+#endif
+    {"scalar", rowMinScalar, minIntoScalar, subtractRowScalar, subtractEachScalar}
+};
+
+Kernels kernels = {"scalar", rowMinScalar, minIntoScalar, subtractRowScalar, subtractEachScalar};     // Kernels in use (set by selectKernels)
+
+/*
+ * Is kernel set usable on this CPU
+ *
+ * @function int kernelsSupported
+ * @param const Kernels *set
+ */
+
+int kernelsSupported(const Kernels *set) {
+#ifdef HAVE_X86_KERNELS
+    __builtin_cpu_init();
+    if (strcmp(set->name, "avx2") == 0)
+        return __builtin_cpu_supports("avx2");
+    if (strcmp(set->name, "sse4.1") == 0)
+        return __builtin_cpu_supports("sse4.1");
+#endif
+    return strcmp(set->name, "scalar") == 0;
+}
+
+/*
+ * Pick kernels - given ones (by name) or best supported ones ("auto")
+ *
+ * @function int selectKernels
+ * @param const char *name
+ *
+ * @return 1 if selected, 0 if unknown or unsupported on this CPU
+ */
+
+int selectKernels(const char *name) {
+    for (size_t i = 0; i < sizeof(kernelSets) / sizeof(kernelSets[0]); ++i) {
+        if ((strcmp(name, "auto") == 0 || strcmp(name, kernelSets[i].name) == 0) && kernelsSupported(&kernelSets[i])) {
+            kernels = kernelSets[i];
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Reduce a single row by its min value
+ *
+ * @function int reduceRow
+ * @param int *mat - Operative matrix (n x n row wise)
+ * @param int n - Amount of elements in haystack
+ * @param int index - Index of row to be worked over
+ */
+
+int reduceRow(int *mat, int n, int index) {
+    int *row = mat + (size_t) index * n;
+    int min = kernels.rowMin(row, n);
+
+    if (min == INT_MAX || min == 0)                     // All infinite or already holds a zero - nothing to subtract
+        return 0;
+
+    kernels.subtractRow(row, min, n);
+    return min;
+}
+
+/*
+ * Reduce every column by its min value - mins gathered and subtracted row by row,
+ * so matrix is only ever walked in row major order
+ *
+ * @function int reduceColumns
+ * @param int *mat - Operative matrix (n x n row wise)
+ * @param int n - Amount of elements in haystack
+ */
+
+int reduceColumns(int *mat, int n) {
+    int colMin[n], CMin = 0, any = 0;
+
+    for (int j = 0; j < n; ++j)
+        colMin[j] = INT_MAX;
+    for (int i = 0; i < n; ++i)                         // Min of each column
+        kernels.minInto(colMin, mat + (size_t) i * n, n);
+
+    for (int j = 0; j < n; ++j) {
+        if (colMin[j] != INT_MAX && colMin[j] != 0) {   // All infinite column only has infinite cells, left as they are
+            CMin += colMin[j];
+            any = 1;
+        }
+    }
+
+    if (any)
+        for (int i = 0; i < n; ++i)
+            kernels.subtractEach(mat + (size_t) i * n, colMin, n);
+
+    return CMin;
+}
+
+/*
+ * Reduction of matrix and derivation of minimal lower bound value
+ *
+ * @function int reduce
+ * @param int *mat - Operative matrix (n x n row wise)
+ * @param int n - AMount of elements in haystack
+ */
+
+int reduce(int *mat, int n) {
+    int RMin = 0, CMin;
+
+    for (int i = 0; i < n; ++i)                         // Reduce each row, sum of Row min (RMin)
+        RMin += reduceRow(mat, n, i);
+
+    CMin = reduceColumns(mat, n);                       // Reduce each column, sum of Column min (CMin)
+
+    return RMin + CMin;     // Return lower bound
+}
+
+/*
+ * Calculation of Cost "C(S)" for an operative matrix
+ * Parent matrix is already reduced - every row and column holds a zero or is all infinite.
+ * Taking edge src -> dest only blanks row src, column dest and [dest][path start], hence the
+ * only lines needing re-reduction are those whose zero sat in a blanked cell.
+ * Rows are re-reduced before columns; subtracting a row min never removes a column's zero,
+ * since a row with positive min held no zero. Columns are re-reduced together in one row major
+ * pass - a column that kept its zero simply has min 0.
+ *
+ * @function int calculateCost
+ * @param int *mat - Reduced matrix of parent node (n x n row wise)
+ * @param int n - Amount of elements in haystack
+ * @param int start - First vertex of relative path (source)
+ * @param int src - Last vertex of parent's relative path
+ * @param int dest - Vertex appended by child
+ * @param int parentRVal - Lower bound of Parent Vertex in relative tree/path
+ * @param int *reducedMat - Resultant reduced matrix of child node
+ */
+
+int calculateCost(int *mat, int n, int start, int src, int dest, int parentRVal, int *reducedMat) {
+    int R = 0;
+    int *srcRow = mat + (size_t) src * n;
+
+    copy(reducedMat, mat, n);                               // Get a backup
+    for (int k = 0; k < n; ++k)                             // Block leaving src again and entering dest again
+        reducedMat[(size_t) src * n + k] = reducedMat[(size_t) k * n + dest] = INT_MAX;
+    reducedMat[(size_t) dest * n + start] = INT_MAX;        // Edge back to start would close the route early
+
+    int closing = mat[(size_t) dest * n + start];
+    int columns = (start != dest && closing == 0);          // Column start may have held its zero at [dest][start]
+
+    for (int k = 0; k < n; ++k) {                           // Rows which held their zero in column dest
+        if (k != src && mat[(size_t) k * n + dest] == 0)
+            R += reduceRow(reducedMat, n, k);
+    }
+    if (dest != src && closing == 0)                        // Row dest may have held its zero at [dest][start]
+        R += reduceRow(reducedMat, n, dest);
+
+    for (int k = 0; k < n && !columns; ++k)                 // Any column which held its zero in row src
+        columns = (k != dest && srcRow[k] == 0);
+    if (columns)
+        R += reduceColumns(reducedMat, n);
+
+    return parentRVal + srcRow[dest] + R;     // Derive cost => C(S) = C(parent) + weight[src][dest] + minimal lower bound (R)
+}
+
+/*
+ * Set up an empty node pool
+ *
+ * @function void initPool
+ * @param NodePool *pool
+ */
+
+void initPool(NodePool *pool) {
+    pool->nodeSize = pool->slabNodeSize = 0;
+    pool->freeList = NULL;
+    pool->slabs = NULL;
+    pool->slabCount = pool->slabCapacity = 0;
+    pool->slabCurrent = -1;
+    pool->slabUsed = POOL_SLAB_NODES;                       // No slab yet, first allocation carves one
+}
+
+/*
+ * Get pool ready for a new search - every node handed out so far is taken back,
+ * slabs are kept and carved again from the first, unless new nodes are bigger
+ *
+ * @function void resetPool
+ * @param NodePool *pool
+ * @param int n - Amount of elements in haystack
+ * @param size_t stateSize - Bytes of bound state per node
+ */
+
+void resetPool(NodePool *pool, int n, size_t stateSize) {
+    pool->nodeSize = (offsetof(Node, data) + n * sizeof(int) + stateSize + sizeof(void *) - 1) / sizeof(void *) * sizeof(void *);   // Keep next node aligned
+
+    if (pool->nodeSize > pool->slabNodeSize) {              // Slabs too small for new nodes
+        for (int i = 0; i < pool->slabCount; ++i)
+            free(pool->slabs[i]);
+        pool->slabCount = 0;
+        pool->slabNodeSize = pool->nodeSize;
+    }
+
+    pool->freeList = NULL;
+    pool->slabCurrent = -1;
+    pool->slabUsed = POOL_SLAB_NODES;
+}
+
+/*
+ * Get a node from pool - recycled if any is free, else carved out of current slab
+ *
+ * @function Node *allocNode
+ * @param NodePool *pool
+ */
+
+Node *allocNode(NodePool *pool) {
+    Node *node = pool->freeList;
+
+    if (node != NULL) {                                     // Reuse released node
+        pool->freeList = node->next;
+        return node;
+    }
+
+    if (pool->slabUsed == POOL_SLAB_NODES) {                // Current slab full, move on to next one (allocated if there's none)
+        if (pool->slabCurrent + 1 == pool->slabCount) {
+            if (pool->slabCount == pool->slabCapacity) {
+                pool->slabCapacity = pool->slabCapacity ? 2 * pool->slabCapacity : 16;
+                pool->slabs = (char **) realloc(pool->slabs, pool->slabCapacity * sizeof(char *));
+            }
+            pool->slabs[pool->slabCount++] = (char *) malloc(POOL_SLAB_NODES * pool->slabNodeSize);
+        }
+        pool->slabCurrent++;
+        pool->slabUsed = 0;
+    }
+
+    return (Node *) (pool->slabs[pool->slabCurrent] + pool->nodeSize * pool->slabUsed++);
+}
+
+/*
+ * Give node back to pool for reuse
+ *
+ * @function void releaseNode
+ * @param NodePool *pool
+ * @param Node *node
+ */
+
+void releaseNode(NodePool *pool, Node *node) {
+    node->next = pool->freeList;
+    pool->freeList = node;
+}
+
+/*
+ * Release every slab of pool (and so every node carved out of it)
+ *
+ * @function void destroyPool
+ * @param NodePool *pool
+ */
+
+void destroyPool(NodePool *pool) {
+    for (int i = 0; i < pool->slabCount; ++i)
+        free(pool->slabs[i]);
+    free(pool->slabs);
+}
+
+/*
+ * State of bound carried by node - right after its path
+ *
+ * @function void *nodeState
+ * @param Search *search
+ * @param Node *node
+ */
+
+void *nodeState(Search *search, Node *node) {
+    return node->data + search->n;
+}
+
+/*
+ * Store working matrix into node cells
+ *
+ * @function void packMatrix
+ * @param int compact - Cells are unsigned short
+ * @param int n - Amount of elements in haystack
+ * @param void *cells - Node cells
+ * @param int *mat - Working matrix (n x n row wise)
+ */
+
+void packMatrix(int compact, int n, void *cells, int *mat) {
+    size_t cellCount = (size_t) n * n;
+
+    if (compact) {
+        unsigned short *small = (unsigned short *) cells;
+        for (size_t c = 0; c < cellCount; ++c)
+            small[c] = (mat[c] == INT_MAX) ? COMPACT_INF : (unsigned short) mat[c];
+    } else {
+        memcpy(cells, mat, cellCount * sizeof(int));
+    }
+}
+
+/*
+ * Expand node cells into working matrix
+ *
+ * @function void unpackMatrix
+ * @param int compact - Cells are unsigned short
+ * @param int n - Amount of elements in haystack
+ * @param void *cells - Node cells
+ * @param int *mat - Resultant working matrix (n x n row wise)
+ */
+
+void unpackMatrix(int compact, int n, void *cells, int *mat) {
+    size_t cellCount = (size_t) n * n;
+
+    if (compact) {
+        unsigned short *small = (unsigned short *) cells;
+        for (size_t c = 0; c < cellCount; ++c)
+            mat[c] = (small[c] == COMPACT_INF) ? INT_MAX : small[c];
+    } else {
+        memcpy(mat, cells, cellCount * sizeof(int));
+    }
+}
+
+/*
+ * Can reduced matrix be held in unsigned short cells - every finite value below COMPACT_INF.
+ * Reduction only lowers values and never below 0, so this holds for every node under root
+ *
+ * @function int fitsCompact
+ * @param int *mat - Reduced root matrix (n x n row wise)
+ * @param int n - Amount of elements in haystack
+ */
+
+int fitsCompact(int *mat, int n) {
+    for (size_t c = 0; c < (size_t) n * n; ++c)
+        if (mat[c] != INT_MAX && (mat[c] < 0 || mat[c] >= COMPACT_INF))
+            return 0;
+    return 1;
+}
+
+/*
+ * Reduction bound - set up reduced root matrix, decide on cell size
+ *
+ * @function size_t reduceSetup
+ * @param Search *search
+ * @param int src - Source vertex
+ */
+
+size_t reduceSetup(Search *search, int src) {
+    ReduceData *data = (ReduceData *) search->cache->data;
+    int n = search->n;
+
+    (void) src;
+    if (data == NULL) {
+        data = (ReduceData *) malloc(sizeof(ReduceData));
+        data->rootMat = (int *) malloc((size_t) search->cache->capacity * search->cache->capacity * sizeof(int));
+        search->cache->data = data;
+    }
+    copy(data->rootMat, search->instance->mat, n);
+    data->rootCost = reduce(data->rootMat, n);          // Root node - source only, reduced matrix
+    data->compact = fitsCompact(data->rootMat, n);      // Half the node size when every weight fits in unsigned short
+
+    return (size_t) n * n * (data->compact ? sizeof(unsigned short) : sizeof(int));
+}
+
+void reduceCleanup(Search *search) {
+    ReduceData *data = (ReduceData *) search->cache->data;
+    free(data->rootMat);
+    free(data);
+}
+
+void *reduceCreateScratch(Search *search) {
+    ReduceScratch *scratch = (ReduceScratch *) malloc(sizeof(ReduceScratch));
+    scratch->parentMat = (int *) malloc((size_t) search->cache->capacity * search->cache->capacity * sizeof(int));
+    scratch->childMat = (int *) malloc((size_t) search->cache->capacity * search->cache->capacity * sizeof(int));
+    return scratch;
+}
+
+void reduceDestroyScratch(void *scratch) {
+    free(((ReduceScratch *) scratch)->parentMat);
+    free(((ReduceScratch *) scratch)->childMat);
+    free(scratch);
+}
+
+int reduceRoot(Search *search, void *scratch, int src) {
+    ReduceData *data = (ReduceData *) search->cache->data;
+    (void) src;
+    copy(((ReduceScratch *) scratch)->childMat, data->rootMat, search->n);
+    return data->rootCost;
+}
+
+void reduceLoad(Search *search, void *scratch, Node *node) {
+    unpackMatrix(((ReduceData *) search->cache->data)->compact, search->n, nodeState(search, node), ((ReduceScratch *) scratch)->parentMat);
+}
+
+int reduceEvaluate(Search *search, void *scratch, Node *node, int dest) {
+    ReduceScratch *work = (ReduceScratch *) scratch;
+    int n = search->n, parent = node->data[node->pathCount - 1];
+
+    if (work->parentMat[(size_t) parent * n + dest] == INT_MAX)    // Edge missing or blocked
+        return INT_MAX;
+
+    return calculateCost(work->parentMat, n, node->data[0], parent, dest, node->cost, work->childMat);
+}
+
+void reduceStore(Search *search, void *scratch, Node *child) {
+    packMatrix(((ReduceData *) search->cache->data)->compact, search->n, nodeState(search, child), ((ReduceScratch *) scratch)->childMat);
+}
+
+/*
+ * Lagrangian 1-tree bound of the rest of a route - from last, through every vertex
+ * of rest, to start. Rest is priced as a spanning tree over symmetric weights, plus
+ * the cheapest edge leaving last and the cheapest entering start (to different vertices
+ * unless only one is left). Penalties pi are added to every weight at a vertex and
+ * twice taken off again, so any pi gives a valid bound; subgradient steps move pi
+ * towards every vertex having degree 2, where the tree is a route
+ *
+ * @function double oneTreeBound
+ * @param Search *search
+ * @param OneTreeScratch *work - rest, restCount and starting pi set; best pi left in bestPi
+ * @param int last - Vertex route continues from
+ * @param int start - Vertex route ends at (source)
+ * @param int iterations - Subgradient steps
+ * @param double target - Bound beyond which node is pruned anyway (INFINITY if no incumbent)
+ *
+ * @return Bound, INFINITY if rest can't be covered at all
+ */
+
+double oneTreeBound(Search *search, OneTreeScratch *work, int last, int start, int iterations, double target) {
+    int n = search->n, count = work->restCount, *rest = work->rest;
+    int *mat = search->instance->mat, *sym = ((OneTreeData *) search->cache->data)->sym;
+    double *pi = work->pi, *key = work->key, best = -INFINITY, lambda = 2.0;
+    int stall = 0;
+
+    for (int it = 0; it < iterations; ++it) {
+        double value = 0, norm = 0;
+
+        for (int t = 0; t < count; ++t) {               // Prim over rest
+            key[t] = INFINITY;
+            work->done[t] = 0;
+            work->link[t] = -1;
+            work->degree[t] = 0;
+        }
+        key[0] = 0;
+        for (int step = 0; step < count; ++step) {
+            int next = -1;
+            for (int t = 0; t < count; ++t)
+                if (!work->done[t] && (next == -1 || key[t] < key[next]))
+                    next = t;
+            if (key[next] == INFINITY)                  // Rest is not connected
+                return INFINITY;
+
+            value += key[next];
+            work->done[next] = 1;
+            if (work->link[next] != -1) {
+                work->degree[next]++;
+                work->degree[work->link[next]]++;
+            }
+
+            int v = rest[next], *row = sym + (size_t) v * n;
+            for (int t = 0; t < count; ++t) {
+                if (work->done[t] || row[rest[t]] == INT_MAX)
+                    continue;
+                double weight = row[rest[t]] + pi[v] + pi[rest[t]];
+                if (weight < key[t]) {
+                    key[t] = weight;
+                    work->link[t] = next;
+                }
+            }
+        }
+
+        int out1 = -1, out2 = -1, in1 = -1, in2 = -1;   // Two cheapest edges leaving last, two entering start
+        double outW1 = INFINITY, outW2 = INFINITY, inW1 = INFINITY, inW2 = INFINITY;
+        for (int t = 0; t < count; ++t) {
+            int v = rest[t];
+            if (mat[(size_t) last * n + v] != INT_MAX) {
+                double weight = mat[(size_t) last * n + v] + pi[v];
+                if (weight < outW1) {
+                    outW2 = outW1; out2 = out1;
+                    outW1 = weight; out1 = t;
+                } else if (weight < outW2) {
+                    outW2 = weight; out2 = t;
+                }
+            }
+            if (mat[(size_t) v * n + start] != INT_MAX) {
+                double weight = mat[(size_t) v * n + start] + pi[v];
+                if (weight < inW1) {
+                    inW2 = inW1; in2 = in1;
+                    inW1 = weight; in1 = t;
+                } else if (weight < inW2) {
+                    inW2 = weight; in2 = t;
+                }
+            }
+        }
+        if (out1 != in1 || count == 1) {
+            value += outW1 + inW1;
+        } else if (outW1 + inW2 <= outW2 + inW1) {
+            value += outW1 + inW2;
+            in1 = in2;
+        } else {
+            value += outW2 + inW1;
+            out1 = out2;
+        }
+        if (out1 == -1 || in1 == -1 || value == INFINITY)    // Last can't leave, or start can't be reached
+            return INFINITY;
+        work->degree[out1]++;
+        work->degree[in1]++;
+
+        for (int t = 0; t < count; ++t)
+            value -= 2 * pi[rest[t]];
+
+        if (value > best) {
+            best = value;
+            for (int t = 0; t < count; ++t)
+                work->bestPi[rest[t]] = pi[rest[t]];
+            stall = 0;
+        } else if (++stall == 4) {                      // Not improving, shorter steps
+            lambda /= 2;
+            stall = 0;
+        }
+
+        if (ceil(best - 1e-6) >= target)                // Prunable already
+            break;
+
+        for (int t = 0; t < count; ++t)
+            norm += (double) (work->degree[t] - 2) * (work->degree[t] - 2);
+        if (norm == 0)                                  // Every degree 2 - tree is a route, bound is exact
+            break;
+
+        double step = lambda * ((target == INFINITY ? 1.05 * fabs(value) + 1 : target) - value) / norm;
+        for (int t = 0; t < count; ++t)
+            pi[rest[t]] += step * (work->degree[t] - 2);
+    }
+
+    return best;
+}
+
+/*
+ * 1-tree bound - set up symmetric weights (min of both directions, so the bound
+ * holds for asymmetric matrices too)
+ *
+ * @function size_t oneTreeSetup
+ * @param Search *search
+ * @param int src - Source vertex
+ */
+
+size_t oneTreeSetup(Search *search, int src) {
+    OneTreeData *data = (OneTreeData *) search->cache->data;
+    int n = search->n, *mat = search->instance->mat;
+
+    (void) src;
+    if (data == NULL) {
+        data = (OneTreeData *) malloc(sizeof(OneTreeData));
+        data->sym = (int *) malloc((size_t) search->cache->capacity * search->cache->capacity * sizeof(int));
+        search->cache->data = data;
+    }
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j)
+            data->sym[(size_t) i * n + j] = mat[(size_t) i * n + j] < mat[(size_t) j * n + i] ? mat[(size_t) i * n + j] : mat[(size_t) j * n + i];
+
+    return sizeof(OneTreeState) + n * sizeof(float);
+}
+
+void oneTreeCleanup(Search *search) {
+    free(((OneTreeData *) search->cache->data)->sym);
+    free(search->cache->data);
+}
+
+void *oneTreeCreateScratch(Search *search) {
+    OneTreeScratch *work = (OneTreeScratch *) calloc(1, sizeof(OneTreeScratch));
+    int n = search->cache->capacity;
+
+    work->visited = (char *) malloc(n);
+    work->rest = (int *) malloc(n * sizeof(int));
+    work->pi = (double *) calloc(n, sizeof(double));
+    work->bestPi = (double *) calloc(n, sizeof(double));
+    work->key = (double *) malloc(n * sizeof(double));
+    work->done = (char *) malloc(n);
+    work->link = (int *) malloc(n * sizeof(int));
+    work->degree = (int *) malloc(n * sizeof(int));
+
+    return work;
+}
+
+void oneTreeDestroyScratch(void *scratch) {
+    OneTreeScratch *work = (OneTreeScratch *) scratch;
+    free(work->visited);
+    free(work->rest);
+    free(work->pi);
+    free(work->bestPi);
+    free(work->key);
+    free(work->done);
+    free(work->link);
+    free(work->degree);
+    free(work);
+}
+
+/*
+ * Bound as integer node cost - route weights are integers, so bound rounds up
+ *
+ * @function int oneTreeCost
+ * @param int pathCost
+ * @param double bound
+ */
+
+int oneTreeCost(int pathCost, double bound) {
+    double cost = pathCost + ceil(bound - 1e-6);
+    return cost >= INT_MAX ? INT_MAX : (int) cost;
+}
+
+int oneTreeRoot(Search *search, void *scratch, int src) {
+    OneTreeScratch *work = (OneTreeScratch *) scratch;
+    int best = __atomic_load_n(&search->best, __ATOMIC_ACQUIRE);
+
+    work->restCount = 0;
+    for (int v = 0; v < search->n; ++v) {
+        work->pi[v] = work->bestPi[v] = 0;
+        if (v != src)
+            work->rest[work->restCount++] = v;
+    }
+    work->pathCost = 0;
+
+    return oneTreeCost(0, oneTreeBound(search, work, src, src, ONE_TREE_ROOT_ITERATIONS, best == INT_MAX ? INFINITY : best));
+}
+
+void oneTreeLoad(Search *search, void *scratch, Node *node) {
+    OneTreeScratch *work = (OneTreeScratch *) scratch;
+
+    memset(work->visited, 0, search->n);
+    for (int i = 0; i < node->pathCount; ++i)
+        work->visited[node->data[i]] = 1;
+    work->parent = (OneTreeState *) nodeState(search, node);
+}
+
+int oneTreeEvaluate(Search *search, void *scratch, Node *node, int dest) {
+    OneTreeScratch *work = (OneTreeScratch *) scratch;
+    int n = search->n, last = node->data[node->pathCount - 1], cost;
+    int weight = search->instance->mat[(size_t) last * n + dest];
+    int best = __atomic_load_n(&search->best, __ATOMIC_ACQUIRE);
+
+    if (weight == INT_MAX)                              // Edge missing
+        return INT_MAX;
+
+    work->pathCost = work->parent->pathCost + weight;
+    work->restCount = 0;
+    for (int v = 0; v < n; ++v) {                       // Warm start - parent's penalties
+        if (work->visited[v] || v == dest)
+            continue;
+        work->rest[work->restCount++] = v;
+        work->pi[v] = work->parent->pi[v];
+    }
+
+    cost = oneTreeCost(work->pathCost, oneTreeBound(search, work, dest, node->data[0], ONE_TREE_CHILD_ITERATIONS,
+                                                    best == INT_MAX ? INFINITY : (double) best - work->pathCost));
+
+    return cost > node->cost ? cost : node->cost;       // Parent's bound holds for child too
+}
+
+void oneTreeStore(Search *search, void *scratch, Node *child) {
+    OneTreeScratch *work = (OneTreeScratch *) scratch;
+    OneTreeState *state = (OneTreeState *) nodeState(search, child);
+
+    state->pathCost = work->pathCost;
+    for (int t = 0; t < work->restCount; ++t)
+        state->pi[work->rest[t]] = (float) work->bestPi[work->rest[t]];
+}
+
+const Bound bounds[] = {
+    {"reduce", reduceSetup, reduceCleanup, reduceCreateScratch, reduceDestroyScratch,
+     reduceRoot, reduceLoad, reduceEvaluate, reduceStore},
+    {"onetree", oneTreeSetup, oneTreeCleanup, oneTreeCreateScratch, oneTreeDestroyScratch,
+     oneTreeRoot, oneTreeLoad, oneTreeEvaluate, oneTreeStore}
+};
+
+/*
+ * Find bound by name
+ *
+ * @function const Bound *getBoundByName
+ * @param const char *name
+ *
+ * @return Bound, NULL if unknown
+ */
+
+const Bound *getBoundByName(const char *name) {
+    for (size_t i = 0; i < sizeof(bounds) / sizeof(bounds[0]); ++i)
+        if (strcmp(bounds[i].name, name) == 0)
+            return &bounds[i];
+    return NULL;
+}
+
+/*
+ * Is weight matrix symmetric
+ *
+ * @function int isSymmetric
+ * @param int *mat - n x n row wise
+ * @param int n - Amount of elements in haystack
+ */
+
+int isSymmetric(int *mat, int n) {
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < i; ++j)
+            if (mat[(size_t) i * n + j] != mat[(size_t) j * n + i])
+                return 0;
+    return 1;
+}
+
+/*
+ * Is node 'a' to be expanded before node 'b' - lesser lower bound first,
+ * deeper node on tie (reaches complete routes, hence pruning, sooner)
+ *
+ * @function int isBefore
+ * @param Node *a
+ * @param Node *b
+ */
+
+int isBefore(Node *a, Node *b) {
+    return a->cost < b->cost || (a->cost == b->cost && a->pathCount > b->pathCount);
+}
+
+/*
+ * Insert live node into heap
+ *
+ * @function void pushNode
+ * @param NodeHeap *heap
+ * @param Node *node
+ */
+
+void pushNode(NodeHeap *heap, Node *node) {
+    int i = heap->size++;
+
+    if (heap->size > heap->capacity) {                      // Grow heap storage
+        heap->capacity = heap->capacity ? 2 * heap->capacity : 64;
+        heap->nodes = (Node **) realloc(heap->nodes, heap->capacity * sizeof(Node *));
+    }
+
+    while (i > 0 && isBefore(node, heap->nodes[(i - 1) / 2])) {     // Sift up
+        heap->nodes[i] = heap->nodes[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    heap->nodes[i] = node;
+}
+
+/*
+ * Remove and return live node with least lower bound
+ *
+ * @function Node *popNode
+ * @param NodeHeap *heap
+ */
+
+Node *popNode(NodeHeap *heap) {
+    Node *top = heap->nodes[0], *last = heap->nodes[--heap->size];
+    int i = 0;
+
+    while (2 * i + 1 < heap->size) {                        // Sift down last node from root
+        int child = 2 * i + 1;
+        if (child + 1 < heap->size && isBefore(heap->nodes[child + 1], heap->nodes[child]))
+            child++;
+        if (!isBefore(heap->nodes[child], last))
+            break;
+        heap->nodes[i] = heap->nodes[child];
+        i = child;
+    }
+    heap->nodes[i] = last;
+
+    return top;
+}
+
+/*
+ * Weight of edge a -> b - looked up in matrix, or rounded Euclidean distance
+ * between points in coordinate mode
+ *
+ * @function int distance
+ * @param Instance *instance
+ * @param int a - Source vertex
+ * @param int b - Destination vertex
+ *
+ * @return Weight, INT_MAX if no edge
+ */
+
+int distance(Instance *instance, int a, int b) {
+    if (instance->mat != NULL)
+        return instance->mat[(size_t) a * instance->n + b];
+    if (a == b)
+        return INT_MAX;
+
+    double dx = instance->x[a] - instance->x[b], dy = instance->y[a] - instance->y[b];
+    return (int) (sqrt(dx * dx + dy * dy) + 0.5);
+}
+
+/*
+ * Cost of complete route over original matrix
+ *
+ * @function int routeCost
+ * @param Instance *instance - Original matrix
+ * @param int[] route - Vertices in visiting order (route returns to route[0])
+ * @param int n - Amount of vertices in route
+ */
+
+int routeCost(Instance *instance, int *route, int n) {
+    long long cost = 0;
+
+    for (int i = 0; i < n; ++i) {
+        int weight = distance(instance, route[i], route[(i + 1) % n]);
+        if (weight == INT_MAX)                              // Missing edge, no such route
+            return INT_MAX;
+        cost += weight;
+    }
+
+    return cost < INT_MAX ? (int) cost : INT_MAX;
+}
+
+/*
+ * Seconds on monotonic clock
+ *
+ * @function double clockSeconds
+ */
+
+double clockSeconds() {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/*
+ * Print a route in visiting order, with cost and time since start of run (anytime mode)
+ *
+ * @function void printIncumbent
+ * @param RunStats *stats - Of run route belongs to
+ * @param int *route - Vertices in visiting order
+ * @param int n - Amount of elements in haystack
+ * @param int cost
+ */
+
+void printIncumbent(RunStats *stats, int *route, int n, int cost) {
+    printf("~ %d %.3fs ", cost, clockSeconds() - stats->start);
+    for (int i = 0; i < n; ++i)
+        printf("%d => ", route[i] + 1);
+    printf("%d\n", route[0] + 1);
+    fflush(stdout);                                         // Seen right away, also by a reader of a pipe
+}
+
+/*
+ * Weight of edge a -> b for local search sums, missing edge weighs ARC_INF
+ *
+ * @function long long arcCost
+ * @param Instance *instance - Original matrix
+ * @param int a - Source vertex
+ * @param int b - Destination vertex
+ */
+
+long long arcCost(Instance *instance, int a, int b) {
+    int weight = distance(instance, a, b);
+    return weight == INT_MAX ? ARC_INF : weight;
+}
+
+/*
+ * Build neighbour lists - k cheapest next vertices of every vertex, cheapest first
+ *
+ * @function int buildNeighbours
+ * @param Instance *instance - Original matrix
+ * @param int n - Amount of elements in haystack
+ * @param int *neighbours - Resultant lists, NEIGHBOUR_K slots per vertex
+ *
+ * @return k - Length of every list
+ */
+
+int buildNeighbours(Instance *instance, int n, int *neighbours) {
+    int k = (n - 1 < NEIGHBOUR_K) ? n - 1 : NEIGHBOUR_K;
+    int weights[NEIGHBOUR_K];
+
+    for (int v = 0; v < n; ++v) {
+        int count = 0, *list = neighbours + (size_t) v * NEIGHBOUR_K;
+        for (int u = 0; u < n; ++u) {                   // Insertion into sorted list, kept at k entries
+            if (u == v)
+                continue;
+            int weight = distance(instance, v, u);
+            int at = count < k ? count++ : k;
+            while (at > 0 && weights[at - 1] > weight) {
+                if (at < k) {
+                    list[at] = list[at - 1];
+                    weights[at] = weights[at - 1];
+                }
+                at--;
+            }
+            if (at < k) {
+                list[at] = u;
+                weights[at] = weight;
+            }
+        }
+    }
+
+    return k;
+}
+
+/*
+ * Nearest neighbour route - from source always go to cheapest unvisited vertex
+ *
+ * @function void nearestNeighbour
+ * @param Instance *instance - Original matrix
+ * @param int n - Amount of elements in haystack
+ * @param int src - Source vertex
+ * @param int[] route - Resultant route, vertices in visiting order
+ * @param char[] visited - Working memory (n)
+ */
+
+void nearestNeighbour(Instance *instance, int n, int src, int *route, char *visited) {
+    memset(visited, 0, n);
+
+    route[0] = src;
+    visited[src] = 1;
+    for (int i = 1; i < n; ++i) {
+        int from = route[i - 1], next = -1, nextWeight = INT_MAX;
+        for (int u = 0; u < n; ++u) {
+            if (visited[u])
+                continue;
+            int weight = distance(instance, from, u);
+            if (next == -1 || weight < nextWeight) {
+                next = u;
+                nextWeight = weight;
+            }
+        }
+        route[i] = next;
+        visited[next] = 1;
+    }
+}
+
+/*
+ * Positions of vertices and prefix sums of route - forward[t] (backward[t]) is the
+ * weight of route[0..t] walked forwards (backwards, every edge reversed)
+ *
+ * @function void indexRoute
+ * @param Instance *instance - Original matrix
+ * @param int n - Amount of elements in haystack
+ * @param int[] route - Vertices in visiting order
+ * @param int[] pos - Resultant position of every vertex
+ * @param long long[] forward
+ * @param long long[] backward
+ */
+
+void indexRoute(Instance *instance, int n, int *route, int *pos, long long *forward, long long *backward) {
+    forward[0] = backward[0] = 0;
+    for (int t = 0; t < n; ++t) {
+        int a = route[t], b = route[(t + 1) % n];
+        pos[a] = t;
+        forward[t + 1] = forward[t] + arcCost(instance, a, b);
+        backward[t + 1] = backward[t] + arcCost(instance, b, a);
+    }
+}
+
+/*
+ * 2-opt pass - replace edges a -> b and c -> d by a -> c and b -> d, walking b..c backwards.
+ * Weights need not be symmetric, so the reversed stretch is priced with prefix sums.
+ * Only c among neighbours of a is tried
+ *
+ * @function int twoOpt
+ * @param Instance *instance - Original matrix
+ * @param int n - Amount of elements in haystack
+ * @param int[] route - Operative route (route[0] stays source)
+ * @param int *neighbours - NEIGHBOUR_K slots per vertex
+ * @param int k - Length of neighbour lists
+ * @param RouteScratch *scratch - Working memory
+ *
+ * @return 1 if route improved
+ */
+
+int twoOpt(Instance *instance, int n, int *route, int *neighbours, int k, RouteScratch *scratch) {
+    int *pos = scratch->pos, improved = 0;
+    long long *forward = scratch->forward, *backward = scratch->backward;
+
+    indexRoute(instance, n, route, pos, forward, backward);
+
+    for (int i = 0; i + 2 < n; ++i) {
+        int a = route[i], b = route[i + 1];
+        for (int x = 0; x < k; ++x) {
+            int c = neighbours[(size_t) a * NEIGHBOUR_K + x], j = pos[c];
+            if (j < i + 2)
+                continue;
+            int d = route[(j + 1) % n];
+            long long delta = arcCost(instance, a, c) + arcCost(instance, b, d) - arcCost(instance, a, b) - arcCost(instance, c, d)
+                              + (backward[j] - backward[i + 1]) - (forward[j] - forward[i + 1]);
+            if (delta >= 0)
+                continue;
+
+            for (int l = i + 1, r = j; l < r; ++l, --r) {   // Reverse b..c
+                int t = route[l];
+                route[l] = route[r];
+                route[r] = t;
+            }
+            indexRoute(instance, n, route, pos, forward, backward);
+            improved = 1;
+            b = route[i + 1];
+        }
+    }
+
+    return improved;
+}
+
+/*
+ * Or-opt pass - move a stretch of 1 to 3 vertices (same direction) in between
+ * some x -> y, y among neighbours of stretch's last vertex
+ *
+ * @function int orOpt
+ * @param Instance *instance - Original matrix
+ * @param int n - Amount of elements in haystack
+ * @param int[] route - Operative route (route[0] stays source)
+ * @param int *neighbours - NEIGHBOUR_K slots per vertex
+ * @param int k - Length of neighbour lists
+ * @param RouteScratch *scratch - Working memory
+ *
+ * @return 1 if route improved
+ */
+
+int orOpt(Instance *instance, int n, int *route, int *neighbours, int k, RouteScratch *scratch) {
+    int *pos = scratch->pos, *moved = scratch->moved, improved = 0;
+    long long *forward = scratch->forward, *backward = scratch->backward;
+
+    indexRoute(instance, n, route, pos, forward, backward);
+
+    for (int length = 1; length <= 3; ++length) {
+        for (int i = 1; i + length <= n; ++i) {         // Stretch route[i..i + length - 1], source never moves
+            int p = route[i - 1], q = route[(i + length) % n];
+            int first = route[i], last = route[i + length - 1];
+            long long removal = arcCost(instance, p, first) + arcCost(instance, last, q) - arcCost(instance, p, q);
+
+            for (int z = 0; z < k; ++z) {
+                int y = neighbours[(size_t) last * NEIGHBOUR_K + z], at = pos[y];
+                if ((at >= i && at < i + length) || y == q)  // Inside stretch, or where it already is
+                    continue;
+                int x = route[(at + n - 1) % n];
+                if (arcCost(instance, x, first) + arcCost(instance, last, y) - arcCost(instance, x, y) - removal >= 0)
+                    continue;
+
+                int count = 0;
+                for (int t = 0; t < n; ++t) {           // Rebuild - stretch goes right before y
+                    if (t >= i && t < i + length)
+                        continue;
+                    if (route[t] == y && t != 0)
+                        for (int s = i; s < i + length; ++s)
+                            moved[count++] = route[s];
+                    moved[count++] = route[t];
+                }
+                if (y == route[0])                      // Before source - at the end
+                    for (int s = i; s < i + length; ++s)
+                        moved[count++] = route[s];
+
+                memcpy(route, moved, n * sizeof(int));
+                indexRoute(instance, n, route, pos, forward, backward);
+                improved = 1;
+                break;
+            }
+        }
+    }
+
+    return improved;
+}
+
+/*
+ * Local search - 2-opt and Or-opt passes till neither improves route or deadline passes
+ *
+ * @function void localSearch
+ * @param Instance *instance - Original matrix
+ * @param int n - Amount of elements in haystack
+ * @param int[] route - Operative route
+ * @param int *neighbours - NEIGHBOUR_K slots per vertex
+ * @param int k - Length of neighbour lists
+ * @param double deadline - clockSeconds() to stop at
+ * @param RouteScratch *scratch - Working memory
+ */
+
+void localSearch(Instance *instance, int n, int *route, int *neighbours, int k, double deadline, RouteScratch *scratch) {
+    int improved = 1;
+
+    while (improved && clockSeconds() < deadline) {
+        improved = twoOpt(instance, n, route, neighbours, k, scratch);
+        improved |= orOpt(instance, n, route, neighbours, k, scratch);
+    }
+}
+
+/*
+ * Exact route of a few vertices - depth first over every visiting order from
+ * source, a partial route is cut off once it costs no less than best so far
+ *
+ * @function void exactRoute
+ * @param Instance *instance - Original matrix
+ * @param int n - Amount of elements in haystack
+ * @param int depth - Vertices on partial route
+ * @param int[] route - Partial route (route[0] - source)
+ * @param long long cost - Cost of partial route
+ * @param char[] visited - Vertices on partial route
+ * @param int[] bestRoute - Best route so far, replaced by cheaper ones
+ * @param long long *best - Cost of bestRoute
+ */
+
+void exactRoute(Instance *instance, int n, int depth, int *route, long long cost, char *visited, int *bestRoute, long long *best) {
+    if (depth == n) {                                   // Complete - close back to source
+        cost += arcCost(instance, route[n - 1], route[0]);
+        if (cost < *best) {
+            *best = cost;
+            memcpy(bestRoute, route, n * sizeof(int));
+        }
+        return;
+    }
+
+    for (int v = 0; v < n; ++v) {
+        if (visited[v])
+            continue;
+        long long next = cost + arcCost(instance, route[depth - 1], v);
+        if (next >= *best)                              // Can't beat best route
+            continue;
+        visited[v] = 1;
+        route[depth] = v;
+        exactRoute(instance, n, depth + 1, route, next, visited, bestRoute, best);
+        visited[v] = 0;
+    }
+}
+
+/*
+ * Random cut points of a double bridge kick, sorted
+ *
+ * @function void randomCuts
+ * @param int n - Amount of elements in haystack
+ * @param int[] cut - Resultant 3 cut points (positions 1 to n - 1)
+ * @param unsigned *seed - State of random generator
+ */
+
+void randomCuts(int n, int *cut, unsigned *seed) {
+    for (int c = 0; c < 3; ++c) {                       // xorshift
+        *seed ^= *seed << 13;
+        *seed ^= *seed >> 17;
+        *seed ^= *seed << 5;
+        cut[c] = 1 + (int) (*seed % (unsigned) (n - 1));
+    }
+    for (int a = 0; a < 2; ++a)                         // Sort cut points
+        for (int b = 0; b < 2 - a; ++b)
+            if (cut[b] > cut[b + 1]) {
+                int t = cut[b];
+                cut[b] = cut[b + 1];
+                cut[b + 1] = t;
+            }
+}
+
+/*
+ * Next cut points of a double bridge kick in lexicographic order - every
+ * 1 <= cut[0] < cut[1] < cut[2] <= n - 1 in turn, then over again
+ *
+ * @function void nextCuts
+ * @param int n - Amount of elements in haystack (at least 4)
+ * @param int[] cut - Current cut points, moved on to next ones
+ */
+
+void nextCuts(int n, int *cut) {
+    if (++cut[2] <= n - 1)
+        return;
+    if (++cut[1] > n - 2 && ++cut[0] > n - 3)
+        cut[0] = 1;
+    if (cut[1] > n - 2)
+        cut[1] = cut[0] + 1;
+    cut[2] = cut[1] + 1;
+}
+
+/*
+ * Double bridge kick - A B C D becomes A C B D (no stretch reversed), a change
+ * local search can't easily undo
+ *
+ * @function void doubleBridge
+ * @param int n - Amount of elements in haystack
+ * @param int[] route - Operative route (route[0] stays source)
+ * @param int[] cut - 3 sorted cut points - A = [0, cut[0]), B = [cut[0], cut[1]), C = [cut[1], cut[2]), D = [cut[2], n)
+ * @param int[] kicked - Working memory (n)
+ */
+
+void doubleBridge(int n, int *route, int *cut, int *kicked) {
+    int count = 0;
+
+    for (int t = 0; t < cut[0]; ++t)
+        kicked[count++] = route[t];
+    for (int t = cut[1]; t < cut[2]; ++t)
+        kicked[count++] = route[t];
+    for (int t = cut[0]; t < cut[1]; ++t)
+        kicked[count++] = route[t];
+    for (int t = cut[2]; t < n; ++t)
+        kicked[count++] = route[t];
+
+    memcpy(route, kicked, n * sizeof(int));
+}
+
+/*
+ * Heuristic route - nearest neighbour, improved by local search. With a time budget,
+ * a route of at most HEURISTIC_EXACT_MAX vertices is solved exactly, a bigger one is
+ * kicked and searched again for as long as budget allows (cut short by deadline of
+ * run or stopRequested). Kicks of a route of at most KICK_ENUMERATE_MAX vertices walk
+ * through every set of cuts - once none of them improves the route, search restarts
+ * from best route kicked twice at random. Kicks of bigger ones are random. Random
+ * cuts are seeded from options.seed and solver->stream, so the same input and
+ * seed kick the same way every run
+ *
+ * @function int heuristic
+ * @param Solver *solver - Buffers, stats
+ * @param Instance *instance - Original matrix
+ * @param int src - Source vertex
+ * @param int[] bestRoute - Resultant route, vertices in visiting order
+ * @param int budgetMs - Time budget (milliseconds), 0 for a single local search
+ *
+ * @return Cost of route (INT_MAX if it uses a missing edge)
+ */
+
+int heuristic(Solver *solver, Instance *instance, int src, int *bestRoute, int budgetMs) {
+    int n = instance->n, k, best, cost;
+    int *neighbours = solver->neighbours, *route = solver->kick, *current = solver->current, currentCost;
+    double deadline = clockSeconds() + (budgetMs > 0 ? budgetMs / 1e3 : 1e9);
+    RunStats *stats = &solver->stats;
+    unsigned seed = options.seed ^ (solver->stream * 2654435761u);     // Every instance of a batch kicks its own way, whichever worker solves it
+    int cut[3] = {1, 2, 3};
+    long cutSets = (long) (n - 1) * (n - 2) * (n - 3) / 6, fruitless = 0;      // Sets of cuts, kicks in a row that found nothing better
+
+    if (deadline > stats->deadline)
+        deadline = stats->deadline;
+
+    k = buildNeighbours(instance, n, neighbours);
+    nearestNeighbour(instance, n, src, bestRoute, solver->scratch.visited);
+    if (n >= 4)
+        localSearch(instance, n, bestRoute, neighbours, k, deadline, &solver->scratch);
+    best = routeCost(instance, bestRoute, n);
+    if (budgetMs > 0) {                                     // Approximate engine - every route it finds counts (seed of bnb is counted by processor())
+        stats->incumbents++;
+        if (options.anytime && best != INT_MAX)
+            printIncumbent(stats, bestRoute, n, best);
+    }
+
+    if (budgetMs > 0 && n <= HEURISTIC_EXACT_MAX) {         // Few vertices - trying every route costs less than kicks
+        char visited[HEURISTIC_EXACT_MAX] = {0};
+        long long exact = (best == INT_MAX) ? LLONG_MAX : best;
+
+        route[0] = src;
+        visited[src] = 1;
+        exactRoute(instance, n, 1, route, 0, visited, bestRoute, &exact);
+        cost = routeCost(instance, bestRoute, n);
+        if (cost < best) {
+            best = cost;
+            stats->incumbents++;
+            if (options.anytime)
+                printIncumbent(stats, bestRoute, n, best);
+        }
+        return best;
+    }
+
+    if (seed == 0)                                          // xorshift would stay at 0
+        seed = 2463534242u;
+
+    memcpy(current, bestRoute, n * sizeof(int));
+    currentCost = best;
+
+    while (budgetMs > 0 && !stopRequested && clockSeconds() < deadline) {    // Iterated local search
+        memcpy(route, current, n * sizeof(int));
+        if (n > KICK_ENUMERATE_MAX) {
+            randomCuts(n, cut, &seed);
+            doubleBridge(n, route, cut, solver->scratch.moved);
+        } else if (fruitless == cutSets) {                  // No kick improves current route - restart from best one, kicked twice
+            memcpy(route, bestRoute, n * sizeof(int));
+            for (int kick = 0; kick < 2; ++kick) {
+                randomCuts(n, cut, &seed);
+                doubleBridge(n, route, cut, solver->scratch.moved);
+            }
+            currentCost = INT_MAX;                          // Taken up whatever it costs
+            fruitless = 0;
+        } else {
+            nextCuts(n, cut);
+            doubleBridge(n, route, cut, solver->scratch.moved);
+            fruitless++;
+        }
+
+        localSearch(instance, n, route, neighbours, k, deadline, &solver->scratch);
+        cost = routeCost(instance, route, n);
+        if (cost < currentCost || currentCost == INT_MAX) {
+            currentCost = cost;
+            fruitless = 0;
+            memcpy(current, route, n * sizeof(int));
+        }
+        if (cost < best) {
+            best = cost;
+            memcpy(bestRoute, route, n * sizeof(int));
+            stats->incumbents++;
+            if (options.anytime)
+                printIncumbent(stats, bestRoute, n, best);
+        }
+    }
+
+    return best;
+}
+
+/*
+ * Offer a complete route as incumbent - kept only if cheaper than current one
+ *
+ * @function void offerRoute
+ * @param Search *search
+ * @param int[] route - Vertices in visiting order
+ * @param int cost - Exact cost of route
+ */
+
+void offerRoute(Search *search, int *route, int cost) {
+    pthread_mutex_lock(&search->incumbentLock);
+    if (cost < search->best) {                              // Better route, new incumbent
+        memcpy(search->bestRoute, route, search->n * sizeof(int));
+        __atomic_store_n(&search->best, cost, __ATOMIC_RELEASE);
+        search->stats->incumbents++;
+        if (options.anytime)
+            printIncumbent(search->stats, route, search->n, cost);
+    }
+    pthread_mutex_unlock(&search->incumbentLock);
+}
+
+/*
+ * Take next live node for a worker - least bound node of own heap, else stolen
+ * least bound node of first other worker that has any
+ *
+ * @function Node *takeNode
+ * @param Search *search
+ * @param int id - Worker index
+ */
+
+Node *takeNode(Search *search, int id) {
+    Node *node = NULL;
+
+    for (int k = 0; k < search->threadCount && node == NULL; ++k) {    // Own heap first, then the others in turn
+        int victim = (id + k) % search->threadCount;
+
+        pthread_mutex_lock(&search->locks[victim]);
+        if (search->heaps[victim].size > 0)
+            node = popNode(&search->heaps[victim]);
+        pthread_mutex_unlock(&search->locks[victim]);
+    }
+
+    return node;
+}
+
+/*
+ * Drop every live node of a worker's own heap - called once its least bound
+ * can't beat incumbent, neither can the rest
+ *
+ * @function long pruneHeap
+ * @param Search *search
+ * @param int id - Worker index
+ *
+ * @return No. of nodes dropped
+ */
+
+long pruneHeap(Search *search, int id) {
+    long dropped = 0;
+
+    pthread_mutex_lock(&search->locks[id]);
+    while (search->heaps[id].size > 0) {
+        releaseNode(&search->pools[id], popNode(&search->heaps[id]));
+        dropped++;
+    }
+    pthread_mutex_unlock(&search->locks[id]);
+
+    __atomic_sub_fetch(&search->outstanding, dropped, __ATOMIC_ACQ_REL);
+
+    return dropped;
+}
+
+/*
+ * Least bound of live nodes in all heaps - no route yet to be found is cheaper
+ * (nodes being expanded aside, so only a close estimate while workers run)
+ *
+ * @function int frontierBound
+ * @param Search *search
+ *
+ * @return Least bound, INT_MAX if no live node is left
+ */
+
+int frontierBound(Search *search) {
+    int least = INT_MAX;
+
+    for (int k = 0; k < search->threadCount; ++k) {
+        pthread_mutex_lock(&search->locks[k]);
+        if (search->heaps[k].size > 0 && search->heaps[k].nodes[0]->cost < least)
+            least = search->heaps[k].nodes[0]->cost;
+        pthread_mutex_unlock(&search->locks[k]);
+    }
+
+    return least;
+}
+
+/*
+ * Sum counters of all workers into stats of search
+ *
+ * @function void collectCounters
+ * @param Search *search
+ */
+
+void collectCounters(Search *search) {
+    RunStats *stats = search->stats;
+
+    stats->expanded = stats->generated = stats->pruned = stats->routes = stats->boundNanos = 0;
+    for (int k = 0; k < search->threadCount; ++k) {
+        SearchCounters *c = &search->counters[k];
+        stats->expanded += __atomic_load_n(&c->expanded, __ATOMIC_RELAXED);
+        stats->generated += __atomic_load_n(&c->generated, __ATOMIC_RELAXED);
+        stats->pruned += __atomic_load_n(&c->pruned, __ATOMIC_RELAXED);
+        stats->routes += __atomic_load_n(&c->routes, __ATOMIC_RELAXED);
+        stats->boundNanos += __atomic_load_n(&c->boundNanos, __ATOMIC_RELAXED);
+    }
+}
+
+/*
+ * Watch over a running search (worker 0 only) - stop it at deadline,
+ * print progress line once interval is up
+ *
+ * @function void watchSearch
+ * @param Search *search
+ */
+
+void watchSearch(Search *search) {
+    RunStats *stats = search->stats;
+    double now;
+
+    if (stats->deadline == INFINITY && options.progressMs <= 0)
+        return;
+
+    now = clockSeconds();
+    if (now >= stats->deadline)
+        __atomic_store_n(&search->stop, 1, __ATOMIC_RELEASE);
+
+    if (options.progressMs > 0 && now >= search->nextProgress) {
+        int best = __atomic_load_n(&search->best, __ATOMIC_ACQUIRE), least = frontierBound(search);
+
+        search->nextProgress = now + options.progressMs / 1e3;
+        collectCounters(search);
+        fprintf(stderr, "[%8.3fs] expanded %lld  live %ld  pruned %lld  ", now - stats->start, stats->expanded,
+                __atomic_load_n(&search->outstanding, __ATOMIC_ACQUIRE), stats->pruned);
+        if (best == INT_MAX)
+            fprintf(stderr, "best -  bound %d\n", least);
+        else
+            fprintf(stderr, "best %d  bound %d  gap %.2f%%\n", best, least < best ? least : best,
+                    least < best ? 100.0 * (best - least) / (best ? best : 1) : 0.0);
+    }
+}
+
+/*
+ * Worker of branch and bound - Expand live nodes (own first, stolen otherwise),
+ * push children on own heap, prune against shared incumbent, till no live node is left anywhere
+ * (or search is stopped)
+ *
+ * @function void *processorWorker
+ * @param void *arg - SearchWorker
+ */
+
+void *processorWorker(void *arg) {
+
+    Search *search = ((SearchWorker *) arg)->search;
+    int id = ((SearchWorker *) arg)->id;
+    int n = search->n;
+    NodePool *pool = &search->pools[id];
+    char *visited = ((SearchWorker *) arg)->visited;
+    int *route = ((SearchWorker *) arg)->route;
+    const Bound *bound = search->bound;
+    void *scratch = search->cache->scratches[id];
+    SearchCounters *counters = &search->counters[id];
+    int timed = options.stats || options.progressMs > 0;   // Time bound evaluations only if anyone looks
+
+    while (1) {
+        if (id == 0)
+            watchSearch(search);
+        if (__atomic_load_n(&stopRequested, __ATOMIC_ACQUIRE) || __atomic_load_n(&search->stop, __ATOMIC_ACQUIRE))   // Signal or deadline - live nodes are left as they are
+            break;
+
+        Node *node = takeNode(search, id);
+
+        if (node == NULL) {
+            if (__atomic_load_n(&search->outstanding, __ATOMIC_ACQUIRE) == 0)      // No live node anywhere, nor one being expanded
+                break;
+            sched_yield();                                  // Others still expanding, their children may be stolen soon
+            continue;
+        }
+
+        if (node->cost >= __atomic_load_n(&search->best, __ATOMIC_ACQUIRE)) {     // Can't beat incumbent
+            releaseNode(pool, node);
+            __atomic_sub_fetch(&search->outstanding, 1, __ATOMIC_ACQ_REL);
+            long dropped = pruneHeap(search, id);           // Own heap pops least bound first, a worse node would be pruned as well
+            __atomic_add_fetch(&counters->pruned, 1 + dropped, __ATOMIC_RELAXED);
+            continue;
+        }
+
+        __atomic_add_fetch(&counters->expanded, 1, __ATOMIC_RELAXED);
+
+        int *path = node->data;                             // Path lies in first n slots of node
+        memset(visited, 0, n);
+        for (int i = 0; i < node->pathCount; ++i)
+            visited[path[i]] = 1;
+
+        bound->load(search, scratch, node);
+
+        for (int i = 0; i < n; ++i) {                       // Branch to each unvisited vertex
+            if (visited[i])
+                continue;
+
+            if (node->pathCount + 1 == n) {                 // Last vertex, route is complete - exact cost
+                int cost;
+
+                memcpy(route, path, node->pathCount * sizeof(int));
+                route[n - 1] = i;
+                cost = routeCost(search->instance, route, n);
+                __atomic_add_fetch(&counters->routes, 1, __ATOMIC_RELAXED);
+
+                if (cost < __atomic_load_n(&search->best, __ATOMIC_ACQUIRE))
+                    offerRoute(search, route, cost);
+                continue;
+            }
+
+            double began = timed ? clockSeconds() : 0;
+            int cost = bound->evaluate(search, scratch, node, i);
+            if (timed)
+                __atomic_add_fetch(&counters->boundNanos, (long long) ((clockSeconds() - began) * 1e9), __ATOMIC_RELAXED);
+
+            if (cost < __atomic_load_n(&search->best, __ATOMIC_ACQUIRE)) {        // Child may still beat incumbent
+                Node *child = allocNode(pool);              // Only surviving children take up a node
+                memcpy(child->data, path, node->pathCount * sizeof(int));
+                child->data[node->pathCount] = i;
+                child->pathCount = node->pathCount + 1;
+                child->cost = cost;
+                bound->store(search, scratch, child);
+
+                __atomic_add_fetch(&search->outstanding, 1, __ATOMIC_ACQ_REL);     // Counted before parent is done, so count never drops to 0 early
+                pthread_mutex_lock(&search->locks[id]);
+                pushNode(&search->heaps[id], child);
+                pthread_mutex_unlock(&search->locks[id]);
+                __atomic_add_fetch(&counters->generated, 1, __ATOMIC_RELAXED);
+            } else {
+                __atomic_add_fetch(&counters->pruned, 1, __ATOMIC_RELAXED);
+            }
+        }
+
+        releaseNode(pool, node);
+        __atomic_sub_fetch(&search->outstanding, 1, __ATOMIC_ACQ_REL);
+    }
+
+    return NULL;
+}
+
+/*
+ * Release data and scratches a search holds for a bound
+ *
+ * @function void releaseBound
+ * @param Search *search
+ * @param int slot - Index of bound in bounds[]
+ */
+
+void releaseBound(Search *search, int slot) {
+    BoundCache *cache = &search->caches[slot];
+
+    search->cache = cache;                                  // Cleanup works on current cache
+    for (int k = 0; k < search->threadCount; ++k)
+        if (cache->scratches[k] != NULL) {
+            bounds[slot].destroyScratch(cache->scratches[k]);
+            cache->scratches[k] = NULL;
+        }
+    if (cache->data != NULL) {
+        bounds[slot].cleanup(search);
+        cache->data = NULL;
+    }
+    cache->capacity = 0;
+}
+
+/*
+ * Best first branch and bound - Always expand the live node with least lower
+ * bound, prune every node whose bound is no better than best complete route.
+ * Spread across worker threads, each with own heap, idle workers steal from busy ones.
+ * Once stopped (stopRequested or deadline), best route so far is returned and stats.stopped is set
+ *
+ * @function int processor
+ * @param Solver *solver - Search kept from previous instances, threads, stats
+ * @param Instance *instance - Original matrix
+ * @param int src - Source vertex
+ * @param int n - Amount of elements in haystack
+ * @param int[] bestRoute - Incumbent route on entry (if seedCost is finite), resultant route
+ * @param int seedCost - Cost of incumbent route on entry (INT_MAX if none)
+ * @param const Bound *bound - Lower bound of nodes
+ */
+
+int processor(Solver *solver, Instance *instance, int src, int n, int *bestRoute, int seedCost, const Bound *bound) {
+
+    Search *search = &solver->search;
+    RunStats *stats = &solver->stats;
+    int threadCount = search->threadCount;
+    Node *root;
+    size_t stateSize;
+
+    if (n > search->caches[bound - bounds].capacity) {     // Bound data and scratches left by earlier searches don't fit
+        releaseBound(search, bound - bounds);
+        search->caches[bound - bounds].capacity = solver->capacity;    // Room for every instance up to biggest one seen so far
+    }
+    search->cache = &search->caches[bound - bounds];
+
+    search->instance = instance;
+    search->n = n;
+    search->best = seedCost;                                // Nodes no better than seed are pruned right away
+    if (seedCost != INT_MAX) {
+        memcpy(search->bestRoute, bestRoute, n * sizeof(int));
+        stats->incumbents++;
+        if (options.anytime)
+            printIncumbent(stats, bestRoute, n, seedCost);
+    }
+    search->outstanding = 1;                                // Root
+    search->bound = bound;
+    search->stop = 0;
+    memset(search->counters, 0, threadCount * sizeof(SearchCounters));
+    search->nextProgress = clockSeconds() + options.progressMs / 1e3;
+    stateSize = bound->setup(search, src);
+    for (int k = 0; k < threadCount; ++k) {
+        if (search->cache->scratches[k] == NULL)
+            search->cache->scratches[k] = bound->createScratch(search);
+        search->heaps[k].size = 0;
+        resetPool(&search->pools[k], n, stateSize);
+    }
+
+    root = allocNode(&search->pools[0]);
+    root->data[0] = src;
+    root->pathCount = 1;
+    root->cost = bound->root(search, search->cache->scratches[0], src);
+    bound->store(search, search->cache->scratches[0], root);
+
+    pushNode(&search->heaps[0], root);                      // Others start by stealing from worker 0
+
+    for (int k = 1; k < threadCount; ++k) {                 // Calling thread works as worker 0
+        solver->searchWorkers[k].search = search;
+        solver->searchWorkers[k].id = k;
+        pthread_create(&solver->threads[k], NULL, processorWorker, &solver->searchWorkers[k]);
+    }
+    solver->searchWorkers[0].search = search;
+    solver->searchWorkers[0].id = 0;
+    processorWorker(&solver->searchWorkers[0]);
+
+    for (int k = 1; k < threadCount; ++k)
+        pthread_join(solver->threads[k], NULL);
+
+    if (search->best != INT_MAX)
+        memcpy(bestRoute, search->bestRoute, n * sizeof(int));
+
+    collectCounters(search);
+    stats->bound = bound->name;
+    stats->stopped = search->outstanding > 0;               // Live nodes left behind
+    stats->lowerBound = stats->stopped ? frontierBound(search) : search->best;
+    if (stats->lowerBound > search->best)
+        stats->lowerBound = search->best;
+
+    return search->best;        // Return the cost of best route
+}
 
 /*
- * Copy one matrix to other - backup
+ * Least cost of reaching last over subset mask - best predecessor among the
+ * other vertices of mask, by the (already solved) smaller subset
  *
- * @function void copy
- * @param int[][] res - Destination matrix
- * @param int[][] mat - Source matrix
- * @param int n - Amount of elements in haystack
+ * @function int heldKarpCell
+ * @param HeldKarp *dp
+ * @param unsigned mask - Subset, holding last
+ * @param int last - End vertex (bit position)
  */
 
-void copy(int res[MAX][MAX], int mat[MAX][MAX], int n) {
-    for (int i = 0; i < n; ++i) {
-        for (int j = 0; j < n; ++j) {
-            res[i][j] = mat[i][j];
+int heldKarpCell(HeldKarp *dp, unsigned mask, int last) {
+    unsigned prevMask = mask & ~(1u << last);
+    int *prevRow = dp->dp + (size_t) prevMask * dp->m;
+    int *in = dp->in[last];
+    int best = INT_MAX;
+
+    for (unsigned rest = prevMask; rest != 0; rest &= rest - 1) {  // Each vertex of smaller subset as predecessor
+        int prev = __builtin_ctz(rest);
+        if (prevRow[prev] == INT_MAX || in[prev] == INT_MAX)
+            continue;
+        long long cost = (long long) prevRow[prev] + in[prev];
+        if (cost < best)
+            best = (int) cost;
+    }
+
+    return best;
+}
+
+/*
+ * Worker of Held-Karp - Fills its share of every layer (subsets of same size),
+ * waiting for everybody before the next layer as it builds upon this one
+ *
+ * @function void *heldKarpWorker
+ * @param void *arg - HeldKarpWorker
+ */
+
+void *heldKarpWorker(void *arg) {
+
+    HeldKarp *dp = ((HeldKarpWorker *) arg)->dp;
+    int id = ((HeldKarpWorker *) arg)->id;
+    int m = dp->m;
+    unsigned full = (1u << m) - 1;
+
+    for (int k = 2; k <= m; ++k) {                              // Subsets of k vertices
+        for (unsigned base = (unsigned) id * HELD_KARP_BLOCK; base <= full; base += (unsigned) dp->threadCount * HELD_KARP_BLOCK) {
+            unsigned end = (full - base < HELD_KARP_BLOCK) ? full : base + HELD_KARP_BLOCK - 1;
+
+            for (unsigned mask = base; ; ++mask) {
+                if (__builtin_popcount(mask) == k) {
+                    int *row = dp->dp + (size_t) mask * m;
+                    for (unsigned rest = mask; rest != 0; rest &= rest - 1) {
+                        int last = __builtin_ctz(rest);
+                        row[last] = heldKarpCell(dp, mask, last);
+                    }
+                }
+                if (mask == end)
+                    break;
+            }
         }
+
+        pthread_barrier_wait(&dp->barrier);                     // Layer done by everybody
     }
+
+    return NULL;
 }
 
 /*
- * Reduce matrix by subtracting min value in row or column
+ * Held-Karp - Exact route by dynamic programming over subsets, O(n^2 * 2^n)
+ * time whatever the weights, subset layers spread across worker threads
  *
- * @function void subtractReduce
- * @param int[][] mat - Operative matrix
+ * @function int heldKarp
+ * @param Solver *solver - Table kept from previous instances, threads
+ * @param int *mat - Original matrix (n x n row wise)
  * @param int n - Amount of elements in haystack
- * @param int index - Index of row/column to be worked over
- * @param int r - Subtractive value
- * @param int decision - Reduce row/column (0 - row, 1 - column)
+ * @param int src - Source vertex
+ * @param int[] bestRoute - Resultant route, vertices in visiting order
+ *
+ * @return Cost of best route (INT_MAX if none), INT_MIN if table could not be allocated
  */
 
-void subtractReduce(int mat[MAX][MAX], int n, int index, int r, int decision){
-    for (int i = 0; i < n; ++i) {
-        if(decision == 0){
-            if (mat[index][i] != INT_MAX)           // If infinite value, no need to subtract
-                mat[index][i] -= r;
-        } else if(decision == 1){
-            if (mat[i][index] != INT_MAX)           // If infinite value, no need to subtract
-                mat[i][index] -= r;
+int heldKarp(Solver *solver, int *mat, int n, int src, int *bestRoute) {
+
+    HeldKarp *dp = &solver->heldKarp;
+    pthread_t *threads = solver->threads;
+    HeldKarpWorker *workers = solver->heldKarpWorkers;
+    int m = n - 1, best = INT_MAX, last = -1, threadCount = solver->threadCount;
+    unsigned full = (1u << m) - 1, mask;
+    size_t cells = ((size_t) 1 << m) * m;
+
+    if (cells > solver->heldKarpCells) {                        // Table of an earlier instance too small
+        free(dp->dp);
+        dp->dp = (int *) malloc(cells * sizeof(int));
+        solver->heldKarpCells = (dp->dp != NULL) ? cells : 0;
+        if (dp->dp == NULL)
+            return INT_MIN;
+    }
+    dp->m = m;
+
+    for (int v = 0, l = 0; v < n; ++v)                          // Bit positions of vertices other than source
+        if (v != src)
+            dp->others[l++] = v;
+    for (int l = 0; l < m; ++l)
+        for (int p = 0; p < m; ++p)
+            dp->in[l][p] = mat[(size_t) dp->others[p] * n + dp->others[l]];
+
+    for (int l = 0; l < m; ++l)                                 // Layer 1 - straight from source
+        dp->dp[((size_t) 1 << l) * m + l] = mat[(size_t) src * n + dp->others[l]];
+
+    if ((unsigned) threadCount > full / HELD_KARP_BLOCK + 1)   // No more workers than blocks of subsets
+        threadCount = (int) (full / HELD_KARP_BLOCK + 1);
+    dp->threadCount = threadCount;
+    pthread_barrier_init(&dp->barrier, NULL, threadCount);
+
+    for (int k = 1; k < threadCount; ++k) {                     // Calling thread works as worker 0
+        workers[k].dp = dp;
+        workers[k].id = k;
+        pthread_create(&threads[k], NULL, heldKarpWorker, &workers[k]);
+    }
+    workers[0].dp = dp;
+    workers[0].id = 0;
+    heldKarpWorker(&workers[0]);
+
+    for (int k = 1; k < threadCount; ++k)
+        pthread_join(threads[k], NULL);
+
+    for (int l = 0; l < m; ++l) {                               // Close route - back to source from best last vertex
+        int reach = dp->dp[(size_t) full * m + l], back = mat[(size_t) dp->others[l] * n + src];
+        if (reach == INT_MAX || back == INT_MAX || (long long) reach + back >= best)
+            continue;
+        best = reach + back;
+        last = l;
+    }
+
+    if (best != INT_MAX) {                                      // Walk back - predecessor whose cell explains current one
+        bestRoute[0] = src;
+        mask = full;
+        for (int pos = m; pos >= 1; --pos) {
+            unsigned prevMask = mask & ~(1u << last);
+            int *prevRow = dp->dp + (size_t) prevMask * m;
+
+            bestRoute[pos] = dp->others[last];
+            if (prevMask == 0)
+                break;
+            for (unsigned rest = prevMask; rest != 0; rest &= rest - 1) {
+                int prev = __builtin_ctz(rest);
+                if (prevRow[prev] != INT_MAX && dp->in[last][prev] != INT_MAX
+                    && (long long) prevRow[prev] + dp->in[last][prev] == dp->dp[(size_t) mask * m + last]) {
+                    last = prev;
+                    break;
+                }
+            }
+            mask = prevMask;
         }
     }
+
+    pthread_barrier_destroy(&dp->barrier);
+
+    return best;        // Return the cost of best route
 }
 
 /*
- * Reduction of matrix and derivation of minimal lower bound value
+ * Read whole of a file descriptor into memory (null terminated)
  *
- * @function int reduce
- * @param int[][] mat - Operative matrix
- * @param int n - AMount of elements in haystack
+ * @function char *readAll
+ * @param int fd
  */
 
-int reduce(int mat[MAX][MAX], int n) {
-    int RMin = 0, CMin = 0, R = 0, min = INT_MAX;
+char *readAll(int fd) {
+    size_t size = 1 << 16, used = 0;
+    char *buffer = (char *) malloc(size);
+    ssize_t got;
 
-    for (int i = 0; i < n; ++i) {                       // Iterate through each row
-        for (int j = 0; j < n; ++j) {                   // For each row, iterate through each column
-            if (mat[i][j] < min)                        // Min check for each value in row
-                min = mat[i][j];
-        }
-        if (min != INT_MAX){
-            subtractReduce(mat, n, i, min, 0);
-            RMin += min;                                // If min not infinity of that row, add it to sum of Row min (RMin)
-        }
-        min = INT_MAX;                                  // Reset min to infinity for next row check
+    while ((got = read(fd, buffer + used, size - used - 1)) > 0) {
+        used += got;
+        if (size - used == 1)                           // Full, grow
+            buffer = (char *) realloc(buffer, size *= 2);
+    }
+    buffer[used] = '\0';
+
+    return buffer;
+}
+
+/*
+ * Parse next integer of input, skipping whitespace before it
+ *
+ * @function int parseInt
+ * @param char **cursor - Input position, advanced past the integer
+ * @param int *value - Resultant integer
+ *
+ * @return 1 if parsed, 0 at end of input, on anything but a whitespace
+ * separated integer, or if it does not fit an int
+ */
+
+int parseInt(char **cursor, int *value) {
+    char *at = *cursor;
+    long long result = 0, limit = INT_MAX;
+    int negative = 0;
+
+    while (isspace((unsigned char) *at))
+        at++;
+    if (*at == '-') {
+        negative = 1;
+        limit = -(long long) INT_MIN;
+        at++;
+    }
+    if (*at < '0' || *at > '9')
+        return 0;
+
+    while (*at >= '0' && *at <= '9') {
+        result = result * 10 + (*at++ - '0');
+        if (result > limit)                             // Stops before long long could overflow too
+            return 0;
     }
+    if (*at != '\0' && !isspace((unsigned char) *at))
+        return 0;
+
+    *value = (int) (negative ? -result : result);
+    *cursor = at;
+    return 1;
+}
+
+/*
+ * Parse next real number of input, skipping whitespace before it
+ *
+ * @function int parseDouble
+ * @param char **cursor - Input position, advanced past the number
+ * @param double *value - Resultant number
+ *
+ * @return 1 if parsed, 0 if none, on anything but a whitespace separated
+ * number, or if it is not finite or beyond COORD_LIMIT
+ */
+
+int parseDouble(char **cursor, double *value) {
+    char *at = *cursor, *end;
 
-    min = INT_MAX;                                      // Reset min to infinity for column check
-    for (int i = 0; i < n; ++i) {                       // Iterate through each column
-        for (int j = 0; j < n; ++j) {                   // For each column, iterate through each row
-            if (mat[j][i] < min)                        // Min check for each value in column
-                min = mat[j][i];
+    while (isspace((unsigned char) *at))
+        at++;
+    if (*at == '\0')
+        return 0;
+
+    *value = strtod(at, &end);
+    if (end == at || (*end != '\0' && !isspace((unsigned char) *end))
+        || !isfinite(*value) || fabs(*value) > COORD_LIMIT)
+        return 0;
+
+    *cursor = end;
+    return 1;
+}
+
+/*
+ * Is anything but whitespace left of input
+ *
+ * @function int moreInput
+ * @param char *cursor - Input position
+ */
+
+int moreInput(char *cursor) {
+    while (isspace((unsigned char) *cursor))            // Same as parseInt() skips
+        cursor++;
+    return *cursor != '\0';
+}
+
+/*
+ * Parse next instance of input into instance - weight matrix (all but diagonal) or,
+ * in coordinate mode, 'x y' of every vertex, then source vertex. Storage of instance
+ * is reused, grown only if it has room for fewer vertices
+ *
+ * @function int parseInstance
+ * @param char **cursor - Input position, advanced past the instance
+ * @param int points - Coordinate mode
+ * @param Instance *instance - Resultant instance (parsed, not mapped)
+ *
+ * @return 1 if parsed, 0 if input is malformed
+ */
+
+int parseInstance(char **cursor, int points, Instance *instance) {
+    int n, src, ok;
+
+    ok = parseInt(cursor, &n) && n >= 1;                // Accept amount of vertices
+
+    if (ok && n > instance->capacity) {                 // Grow storage
+        if (points) {
+            instance->x = (double *) realloc(instance->x, n * sizeof(double));
+            instance->y = (double *) realloc(instance->y, n * sizeof(double));
+        } else {
+            free(instance->mat);
+            instance->mat = (int *) malloc((size_t) n * n * sizeof(int));
         }
-        if (min != INT_MAX){
-            subtractReduce(mat, n, i, min, 1);
-            CMin += min;                                // If min not infinity of that row, add it to sum of Column min (CMin)
+        instance->capacity = n;
+    }
+
+    if (ok && points) {                                 // Accept coordinates
+        for (int i = 0; i < n && ok; ++i)
+            ok = parseDouble(cursor, &instance->x[i]) && parseDouble(cursor, &instance->y[i]);
+    } else if (ok) {                                    // Accept matrix, except same row col values are set to infinity
+        for (int i = 0; i < n && ok; ++i) {
+            int *row = instance->mat + (size_t) i * n;
+            for (int j = 0; j < n && ok; ++j) {
+                if (i != j)
+                    ok = parseInt(cursor, &row[j]);     // Accept weight of edge
+                else
+                    row[j] = INT_MAX;
+            }
         }
-        min = INT_MAX;                                  // Reset min to infinity for next column check
     }
 
-    R = RMin + CMin;                                    // Add both sums of row min and column min to get minimal lower bound
+    ok = ok && parseInt(cursor, &src) && src >= 1 && src <= n;    // Accept source vertex
+    if (!ok)
+        return 0;
 
-    return R;       // Return lower bound
+    instance->n = n;
+    instance->src = src - 1;
+
+    return 1;
 }
 
 /*
- * Set infinity to every row to column instance and haystack[dest][src] as requirement
+ * Read instance from standard input (see parseInstance)
+ *
+ * @function Instance *readInstance
+ * @param int points - Coordinate mode
  *
- * @function void resolveInfinity
- * @param int[][] mat - Operative matrix
- * @param int n - Amount of elements in matrix
- * @param int[] path - Relative path/tree of vertex connections
- * @param int paramCount - Amount of vertices in relative tree/path
+ * @return Instance, NULL if input is malformed
  */
 
-void resolveInfinity(int mat[MAX][MAX], int n, int path[MAX], int pathCount) {
-    for (int i = 0; i < pathCount - 1; ++i) {
-        int src = path[i], dest = path[i + 1];
-        for (int j = 0; j < n; ++j) {
-            mat[src][j] = mat[j][dest] = INT_MAX;
-        }
-        mat[dest][src] = INT_MAX;
+Instance *readInstance(int points) {
+    char *buffer = readAll(STDIN_FILENO), *cursor = buffer;
+    Instance *instance = (Instance *) calloc(1, sizeof(Instance));
+    int ok = parseInstance(&cursor, points, instance);
+
+    free(buffer);
+
+    if (!ok) {
+        fprintf(stderr, "Malformed input\n");
+        free(instance->mat);
+        free(instance->x);
+        free(instance->y);
+        free(instance);
+        return NULL;
     }
+
+    return instance;
 }
 
 /*
- * Calculation of Cost "C(S)" for an operative matrix
+ * Full weight matrix of instance (computed from coordinates if need be)
  *
- * @function int calculateCost
- * @param int[][] mat - Operative matrix
- * @param int n - Amount of elements in haystack
- * @param int[] path - Relative path/tree of vertex connections
- * @param int pathCount - Amount of vertices in relative tree/path
- * @param int parentRVal - Lower bound of Parent Vertex in relative tree/path
+ * @function void buildMatrix
+ * @param Instance *instance
+ * @param int *mat - Resultant n x n weights row wise
  */
 
-int calculateCost(int mat[MAX][MAX], int n, int path[MAX], int pathCount, int parentRVal) {
-    int cost, R, reducedMat[MAX][MAX];
-    int src = path[pathCount - 2];
-    int dest = path[pathCount - 1];
+void buildMatrix(Instance *instance, int *mat) {
+    int n = instance->n;
 
-    copy(reducedMat, mat, n);                               // Get a backup
-    resolveInfinity(reducedMat, n, path, pathCount);        // Resolve inifinity
-    R = reduce(reducedMat, n);                              // Get minimal lower bound
-    cost = parentRVal + mat[src][dest] + R;                 // Derive cost => C(S) = C(parent) + weight[src][dest] + minimal lower bound (R)
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j)
+            mat[(size_t) i * n + j] = distance(instance, i, j);
+}
 
-    return cost;        // Return lower bound/cost
+/*
+ * Write instance to binary matrix file (header, then full weight matrix)
+ *
+ * Returns '1' if written else '0'
+ *
+ * @function int writeMatrixFile
+ * @param Instance *instance
+ * @param char *path - File to be written
+ */
+
+int writeMatrixFile(Instance *instance, char *path) {
+
+    FILE *file = fopen(path, "wb");
+    MatrixHeader header;
+    int n = instance->n;
+    int *row = (int *) malloc(n * sizeof(int));
+
+    if (file == NULL) {
+        perror(path);
+        free(row);
+        return 0;
+    }
+
+    memcpy(header.magic, MATRIX_MAGIC, sizeof(header.magic));
+    header.version = MATRIX_VERSION;
+    header.n = n;
+    header.src = instance->src;
+
+    fwrite(&header, sizeof(header), 1, file);
+    for (int i = 0; i < n; ++i) {                       // Row by row, coordinates never need a full matrix in memory
+        for (int j = 0; j < n; ++j)
+            row[j] = distance(instance, i, j);
+        fwrite(row, sizeof(int), n, file);
+    }
+
+    free(row);
+
+    if (ferror(file) | fclose(file)) {
+        perror(path);
+        return 0;
+    }
+
+    return 1;
 }
 
 /*
- * Get minimum lower bound from haystack
+ * Load instance from binary matrix file - file is mapped into memory and the
+ * matrix used right where it lies, nothing is parsed
  *
- * @function int getMinR
- * @param int[] haystack - Haystack for search
- * @param int n - Amount of elements in haystack
+ * @function Instance *loadMatrixFile
+ * @param char *path
+ *
+ * @return Instance, NULL if file can't be read or isn't a matrix file
  */
 
-int getMinR(int haystack[MAX], int n) {
-    int min = haystack[0];
+Instance *loadMatrixFile(char *path) {
 
-    for (int i = 1; i < n; ++i) {
-        if (haystack[i] < min)
-            min = haystack[i];
+    int fd = open(path, O_RDONLY);
+    struct stat info;
+    void *mapping;
+    MatrixHeader *header;
+    Instance *instance;
+
+    if (fd == -1 || fstat(fd, &info) == -1) {
+        perror(path);
+        return NULL;
     }
 
-    return min;
+    mapping = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);                                          // Mapping stays valid without descriptor
+
+    if (mapping == MAP_FAILED) {
+        perror(path);
+        return NULL;
+    }
+
+    header = (MatrixHeader *) mapping;
+
+    if ((size_t) info.st_size < sizeof(MatrixHeader)    // Validate header and size before trusting n
+        || memcmp(header->magic, MATRIX_MAGIC, sizeof(header->magic)) != 0
+        || header->version != MATRIX_VERSION
+        || header->n < 1 || header->src < 0 || header->src >= header->n
+        || (size_t) info.st_size != sizeof(MatrixHeader) + (size_t) header->n * header->n * sizeof(int)) {
+        fprintf(stderr, "'%s' is not a matrix file (version %d)\n", path, MATRIX_VERSION);
+        munmap(mapping, info.st_size);
+        return NULL;
+    }
+
+    instance = (Instance *) calloc(1, sizeof(Instance));
+    instance->n = header->n;
+    instance->src = header->src;
+    instance->mat = (int *) (header + 1);               // Matrix follows header
+    instance->mapping = mapping;
+    instance->mappingSize = info.st_size;
+
+    return instance;
 }
 
 /*
- * Processing each child over reduction and lower bound discovery for next vertex discovery
+ * Release instance (unmap matrix file if mapped)
  *
- * @function int processor
- * @param int[][] mat - Operative matrix
- * @param int[] path - Resultant route
- * @param int n - Amount of elements in haystack
- * @param int[] relativePath - Relative path/tree of vertex connections
- * @param int relativeCount - Amount of vertices in relative tree/path
- * @param int[] visited - Tracking of unvisited vertices
- * @param int visitedCount - Count of unvisited vertices
- * @param int parent - Parent vertex
- * @param int parentRVal - Lower bound of Parent Vertex in relative tree/path
+ * @function void destroyInstance
+ * @param Instance *instance
+ */
+
+void destroyInstance(Instance *instance) {
+    if (instance->mapping != NULL)
+        munmap(instance->mapping, instance->mappingSize);
+    else
+        free(instance->mat);
+    free(instance->x);
+    free(instance->y);
+    free(instance);
+}
+
+/*
+ * Set up a solver with no buffers yet - they are allocated by the first
+ * instance solved, and grown by bigger ones only
+ *
+ * @function void initSolver
+ * @param Solver *solver
+ * @param int threadCount - Workers within an instance
  */
 
-int processor(int mat[MAX][MAX], int path[MAX], int n, int relativePath[MAX], int relativePathCount, int visited[MAX],
-              int visitedCount, int parent, int parentRVal) {
+void initSolver(Solver *solver, int threadCount) {
+    Search *search = &solver->search;
 
-    int minRVal, childR[n], temp[MAX][MAX], minIndex;
+    memset(solver, 0, sizeof(Solver));
+    solver->threadCount = (threadCount < 1) ? 1 : threadCount;
 
-    for (int i = 0; i < n; ++i) {
-        if (i != parent && visited[i] == 0) {       // Get lower bound of each unvisited node except parent, else set infinity
-            copy(temp, mat, n);
-            relativePath[relativePathCount] = i;
-            childR[i] = calculateCost(temp, n, relativePath, relativePathCount+1, parentRVal);
-        } else
-            childR[i] = INT_MAX;
+    search->threadCount = solver->threadCount;
+    search->stats = &solver->stats;
+    search->heaps = (NodeHeap *) calloc(search->threadCount, sizeof(NodeHeap));
+    search->pools = (NodePool *) malloc(search->threadCount * sizeof(NodePool));
+    search->locks = (pthread_mutex_t *) malloc(search->threadCount * sizeof(pthread_mutex_t));
+    for (int b = 0; b < BOUND_COUNT; ++b)
+        search->caches[b].scratches = (void **) calloc(search->threadCount, sizeof(void *));
+    search->counters = (SearchCounters *) calloc(search->threadCount, sizeof(SearchCounters));
+    for (int k = 0; k < search->threadCount; ++k) {
+        initPool(&search->pools[k]);
+        pthread_mutex_init(&search->locks[k], NULL);
     }
+    pthread_mutex_init(&search->incumbentLock, NULL);
+
+    solver->threads = (pthread_t *) malloc(solver->threadCount * sizeof(pthread_t));
+    solver->searchWorkers = (SearchWorker *) calloc(solver->threadCount, sizeof(SearchWorker));
+    solver->heldKarpWorkers = (HeldKarpWorker *) malloc(solver->threadCount * sizeof(HeldKarpWorker));
+}
+
+/*
+ * Make room for instances of up to n vertices
+ *
+ * @function void reserveSolver
+ * @param Solver *solver
+ * @param int n - Amount of elements in haystack
+ */
 
-    minRVal = getMinR(childR, n);           // Get minimum lower bound to proceed to
+void reserveSolver(Solver *solver, int n) {
+    if (n <= solver->capacity)
+        return;
 
-    for (int i = 0; i < n; ++i) {           // Find the vertex deriving minimum lower bound
-        if (minRVal == childR[i])
-            minIndex = i;
+    solver->route = (int *) realloc(solver->route, n * sizeof(int));
+    solver->kick = (int *) realloc(solver->kick, n * sizeof(int));
+    solver->current = (int *) realloc(solver->current, n * sizeof(int));
+    solver->neighbours = (int *) realloc(solver->neighbours, (size_t) n * NEIGHBOUR_K * sizeof(int));
+    solver->scratch.pos = (int *) realloc(solver->scratch.pos, n * sizeof(int));
+    solver->scratch.forward = (long long *) realloc(solver->scratch.forward, (n + 1) * sizeof(long long));
+    solver->scratch.backward = (long long *) realloc(solver->scratch.backward, (n + 1) * sizeof(long long));
+    solver->scratch.moved = (int *) realloc(solver->scratch.moved, n * sizeof(int));
+    solver->scratch.visited = (char *) realloc(solver->scratch.visited, n);
+    solver->search.bestRoute = (int *) realloc(solver->search.bestRoute, n * sizeof(int));
+    for (int k = 0; k < solver->threadCount; ++k) {
+        solver->searchWorkers[k].visited = (char *) realloc(solver->searchWorkers[k].visited, n);
+        solver->searchWorkers[k].route = (int *) realloc(solver->searchWorkers[k].route, n * sizeof(int));
     }
+    solver->capacity = n;
+}
+
+/*
+ * Release everything a solver holds
+ *
+ * @function void destroySolver
+ * @param Solver *solver
+ */
+
+void destroySolver(Solver *solver) {
+    Search *search = &solver->search;
 
-    /* Proceed to that vertex
-     * (path => which vertex to proceed from current [useful after derivation of whole tree],
-     * relativePath => fixed vertex in the path to continue with)
-     */
-    path[parent] = relativePath[relativePathCount++] = minIndex;
-    visited[minIndex] = 1;
-    visitedCount++;
+    for (int b = 0; b < BOUND_COUNT; ++b) {
+        releaseBound(search, b);
+        free(search->caches[b].scratches);
+    }
+    for (int k = 0; k < search->threadCount; ++k) {
+        free(search->heaps[k].nodes);
+        destroyPool(&search->pools[k]);
+        pthread_mutex_destroy(&search->locks[k]);
+    }
+    pthread_mutex_destroy(&search->incumbentLock);
+    free(search->heaps);
+    free(search->pools);
+    free(search->locks);
+    free(search->counters);
+    free(search->bestRoute);
 
-    if (visitedCount < n) {     // If not visited all vertices, continue the derivation
-        return processor(mat, path, n, relativePath, relativePathCount, visited, visitedCount, minIndex, minRVal);
+    free(solver->route);
+    free(solver->kick);
+    free(solver->current);
+    free(solver->neighbours);
+    free(solver->scratch.pos);
+    free(solver->scratch.forward);
+    free(solver->scratch.backward);
+    free(solver->scratch.moved);
+    free(solver->scratch.visited);
+    for (int k = 0; k < solver->threadCount; ++k) {
+        free(solver->searchWorkers[k].visited);
+        free(solver->searchWorkers[k].route);
     }
+    free(solver->dense);
+    free(solver->heldKarp.dp);
+    free(solver->threads);
+    free(solver->searchWorkers);
+    free(solver->heldKarpWorkers);
+}
+
+/*
+ * Clear stats for a new run, starting now
+ *
+ * @function void resetStats
+ * @param RunStats *stats
+ */
 
-    return minRVal;     // Return the cost of current matrix distance covered
+void resetStats(RunStats *stats) {
+    memset(stats, 0, sizeof(RunStats));
+    stats->start = clockSeconds();
+    stats->deadline = (options.deadlineMs > 0) ? stats->start + options.deadlineMs / 1e3 : INFINITY;
 }
 
 /*
  * Kick start of the sequence
  *
  * @function int TSP
- * @param int[][] mat - Operative matrix
- * @param int[] path - Resultant route
- * @param int n - Amount of elements in Haystack
+ * @param Solver *solver - Context (buffers reused across calls), stats of run left in solver->stats
+ * @param Instance *instance - Operative matrix (or coordinates)
+ * @param int[] path - Resultant route (path[vertex] - next vertex in route)
  * @param int src - Source vertex to start rote from
  */
 
-int TSP(int mat[MAX][MAX], int path[MAX], int n, int src) {
-    int R, reducedMat[MAX][MAX], relativePath[MAX], relativePathCount = 0, visited[MAX], visitedCount = 0;
+int TSP(Solver *solver, Instance *instance, int *path, int src) {
+    int n = instance->n, best = INT_MIN;
+    int *route;
+    Instance dense = *instance;                     // Exact engines work over a full matrix
+    RunStats *stats = &solver->stats;
+    double began = clockSeconds();
+
+    if (n == 1) {                                   // Only source, nothing to travel
+        path[src] = src;
+        stats->best = stats->lowerBound = 0;
+        return 0;
+    }
 
-    copy(reducedMat, mat, n);
-    R = reduce(reducedMat, n);
+    reserveSolver(solver, n);
+    route = solver->route;
 
-    path[src]  = -1;
-    relativePath[relativePathCount++] = src;
-    visited[src] = 1;
-    visitedCount++;
+    if (options.engine == ENGINE_APPROXIMATE) {     // Straight over coordinates, no n x n matrix needed
+        stats->engine = engineNames[ENGINE_APPROXIMATE];
+        best = heuristic(solver, instance, src, route, options.budgetMs > 0 ? options.budgetMs : 1);
+        stats->lowerBound = INT_MIN;                // No bound proven
+        stats->stopped = stopRequested;
+    } else {
+        if (dense.mat == NULL) {
+            if (n > solver->denseCapacity) {
+                free(solver->dense);
+                solver->dense = (int *) malloc((size_t) n * n * sizeof(int));
+                solver->denseCapacity = n;
+            }
+            dense.mat = solver->dense;
+            buildMatrix(instance, dense.mat);
+        }
+
+        if (options.engine == ENGINE_HELD_KARP || (options.engine == ENGINE_AUTO && n <= HELD_KARP_MAX))
+            best = heldKarp(solver, dense.mat, n, src, route);
+        if (best != INT_MIN) {
+            stats->engine = engineNames[ENGINE_HELD_KARP];
+            stats->lowerBound = best;
+        }
 
-    return processor(reducedMat, path, n, relativePath, relativePathCount, visited, visitedCount, src, R);
+        if (best == INT_MIN) {                      // Branch and bound (also if Held-Karp table didn't fit in memory)
+            int seedCost = heuristic(solver, &dense, src, route, 0);    // Upper bound to prune against from the start
+            const Bound *bound = options.bound;
+
+            if (bound == NULL)                      // 1-tree is far tighter on symmetric weights, reduction on asymmetric
+                bound = getBoundByName(isSymmetric(dense.mat, n) ? "onetree" : "reduce");
+
+            stats->engine = engineNames[ENGINE_BRANCH_BOUND];
+            best = processor(solver, &dense, src, n, route, seedCost, bound);
+        }
+    }
+
+    if (best != INT_MAX)
+        for (int i = 0; i < n; ++i)                 // Visiting order to next vertex of each vertex
+            path[route[i]] = route[(i + 1) % n];
+
+    stats->best = best;
+    stats->seconds = clockSeconds() - began;
+
+    return best;
 
 }
 
@@ -239,50 +2841,415 @@ int TSP(int mat[MAX][MAX], int path[MAX], int n, int src) {
  * @param int src - Source vertex
  */
 
-void viewPath(int path[MAX], int n, int src){
+void viewPath(int *path, int n, int src){
     int iter = 0;
 
     do{
-        printf("%d", src+1);            // Print index+1 as vertex name
+        printf("%d => ", src+1);        // Print index+1 as vertex name
         src = path[src];                // Goto next vertex
         iter++;
-        if(iter != n)
-            printf(" => ");             // If last vertex, don't print arrow
     }while (iter != n);                 // Run till all vertices covered
 
-    printf("%d", src+1);
+    printf("%d", src+1);                // Back to source vertex
+}
+
+/*
+ * Dump statistics of run as a JSON object
+ *
+ * @function void printStats
+ * @param FILE *out
+ * @param Solver *solver - Solver of run
+ * @param int n - Amount of elements in haystack
+ */
+
+void printStats(FILE *out, Solver *solver, int n) {
+    RunStats *stats = &solver->stats;
+
+    fprintf(out, "\n{\"engine\": \"%s\", \"bound\": ", stats->engine ? stats->engine : "none");
+    if (stats->bound)
+        fprintf(out, "\"%s\"", stats->bound);
+    else
+        fprintf(out, "null");
+    fprintf(out, ", \"vertices\": %d, \"threads\": %d, \"seconds\": %.6f", n, solver->threadCount, stats->seconds);
+    fprintf(out, ", \"expanded\": %lld, \"generated\": %lld, \"pruned\": %lld, \"routes\": %lld",
+            stats->expanded, stats->generated, stats->pruned, stats->routes);
+    fprintf(out, ", \"boundSeconds\": %.6f, \"microsPerExpansion\": %.3f, \"incumbents\": %d",
+            stats->boundNanos / 1e9, stats->expanded ? stats->seconds * 1e6 / stats->expanded : 0.0, stats->incumbents);
+
+    if (stats->best == INT_MAX)
+        fprintf(out, ", \"best\": null");
+    else
+        fprintf(out, ", \"best\": %d", stats->best);
+    if (stats->lowerBound == INT_MIN || stats->best == INT_MAX)
+        fprintf(out, ", \"lowerBound\": null, \"gap\": null");
+    else
+        fprintf(out, ", \"lowerBound\": %d, \"gap\": %.6f", stats->lowerBound,
+                stats->best ? (double) (stats->best - stats->lowerBound) / stats->best : 0.0);
+    fprintf(out, ", \"stopped\": %s}\n", stats->stopped ? "true" : "false");
+}
+
+/*
+ * Print result of an instance - minimum route distance and route on stdout,
+ * note on stderr if search was stopped, statistics if asked for
+ *
+ * @function void printResult
+ * @param Solver *solver - Solver instance was solved by
+ * @param int[] path - Route (path[vertex] - next vertex in route)
+ * @param int n - Amount of elements in haystack
+ * @param int src - Source vertex
+ * @param int minRouteDist - Cost of route (INT_MAX if none)
+ */
+
+void printResult(Solver *solver, int *path, int n, int src, int minRouteDist) {
+    if (minRouteDist == INT_MAX)                // Some edges missing, no route covers all vertices
+        printf("\n-\n");
+    else {
+        printf("\n%d\n\n", minRouteDist);
+        viewPath(path, n, src);                 // View route
+    }
+    fflush(stdout);
+
+    if (solver->stats.stopped)
+        fprintf(stderr, minRouteDist == INT_MAX ? "\nSearch stopped before any route was found\n"
+                                                : "\nSearch stopped, route is best found so far, not proven optimal\n");
+    if (options.stats)
+        printStats(stderr, solver, n);
+}
+
+/*
+ * Worker of batch mode - take next instance of input, solve it with own solver,
+ * wait for results of all earlier instances to be printed, print own. Till input
+ * runs out (or is malformed, or stop is requested)
+ *
+ * @function void *batchWorker
+ * @param void *arg - BatchWorker
+ */
+
+void *batchWorker(void *arg) {
+    BatchWorker *worker = (BatchWorker *) arg;
+    Batch *batch = worker->batch;
+    Instance *instance = worker->instance;
+
+    while (1) {
+        long seq;
+        int best;
+
+        pthread_mutex_lock(&batch->inputLock);          // Instances are parsed in turn, straight into own storage
+        if (batch->error != NULL || stopRequested || !moreInput(batch->cursor)) {
+            pthread_mutex_unlock(&batch->inputLock);
+            break;
+        }
+        seq = batch->nextInput++;
+        if (!parseInstance(&batch->cursor, batch->points, instance))
+            batch->error = "Malformed input";
+        else if (options.engine == ENGINE_HELD_KARP && instance->n > HELD_KARP_LIMIT) {
+            snprintf(batch->errorText, sizeof(batch->errorText), "Held-Karp is limited to %d vertices", HELD_KARP_LIMIT);
+            batch->error = batch->errorText;
+        }
+        if (batch->error != NULL) {                     // Nothing is handed out past it, earlier instances still finish
+            batch->errorAt = seq;
+            pthread_mutex_unlock(&batch->inputLock);
+            break;
+        }
+        pthread_mutex_unlock(&batch->inputLock);
+
+        if (instance->n > worker->pathCapacity) {
+            worker->path = (int *) realloc(worker->path, instance->n * sizeof(int));
+            worker->pathCapacity = instance->n;
+        }
+
+        resetStats(&worker->solver.stats);              // Deadline counts per instance
+        worker->solver.stream = (unsigned) seq;
+        best = TSP(&worker->solver, instance, worker->path, instance->src);
+
+        pthread_mutex_lock(&batch->outputLock);         // Results in input order
+        while (batch->nextOutput != seq)
+            pthread_cond_wait(&batch->turn, &batch->outputLock);
+        printResult(&worker->solver, worker->path, instance->n, instance->src, best);
+        printf("\n");
+        batch->nextOutput++;
+        pthread_cond_broadcast(&batch->turn);
+        pthread_mutex_unlock(&batch->outputLock);
+    }
+
+    return NULL;
+}
+
+/*
+ * Batch mode - solve every instance of standard input, one after other, across
+ * worker threads (each solving its instances single threaded, with a solver of its
+ * own reused for all of them), results printed in input order
+ *
+ * @function int solveBatch
+ * @param int points - Coordinate mode
+ * @param int workerCount - No. of worker threads
+ *
+ * @return 1 if every instance was solved, 0 if input was malformed somewhere
+ */
+
+int solveBatch(int points, int workerCount) {
+    char *buffer = readAll(STDIN_FILENO);
+    Batch batch;
+    BatchWorker *workers;
+    pthread_t *threads;
+
+    if (workerCount < 1)
+        workerCount = 1;
+
+    batch.cursor = buffer;
+    batch.points = points;
+    batch.nextInput = batch.nextOutput = 0;
+    batch.error = NULL;
+    batch.errorAt = -1;
+    pthread_mutex_init(&batch.inputLock, NULL);
+    pthread_mutex_init(&batch.outputLock, NULL);
+    pthread_cond_init(&batch.turn, NULL);
+
+    workers = (BatchWorker *) calloc(workerCount, sizeof(BatchWorker));
+    threads = (pthread_t *) malloc(workerCount * sizeof(pthread_t));
+
+    for (int k = 0; k < workerCount; ++k) {
+        workers[k].batch = &batch;
+        workers[k].instance = (Instance *) calloc(1, sizeof(Instance));
+        initSolver(&workers[k].solver, 1);
+    }
+    for (int k = 1; k < workerCount; ++k)                   // Calling thread works as worker 0
+        pthread_create(&threads[k], NULL, batchWorker, &workers[k]);
+    batchWorker(&workers[0]);
+    for (int k = 1; k < workerCount; ++k)
+        pthread_join(threads[k], NULL);
+
+    if (batch.error != NULL)
+        fprintf(stderr, "%s (instance %ld)\n", batch.error, batch.errorAt + 1);
+    else if (stopRequested && moreInput(batch.cursor))
+        fprintf(stderr, "Batch stopped after %ld instances\n", batch.nextOutput);
+
+    for (int k = 0; k < workerCount; ++k) {
+        destroySolver(&workers[k].solver);
+        destroyInstance(workers[k].instance);
+        free(workers[k].path);
+    }
+    pthread_mutex_destroy(&batch.inputLock);
+    pthread_mutex_destroy(&batch.outputLock);
+    pthread_cond_destroy(&batch.turn);
+    free(workers);
+    free(threads);
+    free(buffer);
+
+    return batch.error == NULL;
+}
+
+/*
+ * Ask running search to stop (SIGINT / SIGTERM) - best route so far is still printed
+ *
+ * @function void requestStop
+ * @param int signal
+ */
+
+void requestStop(int signal) {
+    (void) signal;
+    stopRequested = 1;
+}
+
+/*
+ * Find engine by name
+ *
+ * @function int getEngineByName
+ * @param const char *name
+ *
+ * @return Engine, -1 if unknown
+ */
+
+int getEngineByName(const char *name) {
+    for (int i = 0; i < (int) (sizeof(engineNames) / sizeof(engineNames[0])); ++i)
+        if (strcmp(engineNames[i], name) == 0)
+            return i;
+    return -1;
 }
 
 /*
  * Start of Execution
  */
 
-int main() {
-    int mat[MAX][MAX], path[MAX], n, src, minRouteDist;
+int main(int argc, char *argv[]) {
+    int *path, n, src, minRouteDist, opt;
+    const char *kernelName = "auto";
+    char *matrixPath = NULL;                // Binary matrix file to load ("-m"), NULL to read text input
+    char *convertPath = NULL;               // Binary matrix file to write ("-c"), NULL to solve
+    int points = 0;                         // Text input holds coordinates instead of a matrix ("-p")
+    int batchMode = 0;                      // Stream of instances on input ("-S")
+    Instance *instance;
+    Solver solver;
+    struct sigaction stop;
 
-    scanf("%d", &n);                            // Accept amount of vertices
+    options.threadCount = (int) sysconf(_SC_NPROCESSORS_ONLN);  // Default - one worker per online core
 
-    for (int i = 0; i < n; ++i) {               // Accept matrix, except same row col values are set to infinity
-        for (int j = 0; j < n; ++j) {
-            if (i != j) {
-                scanf("%d", &mat[i][j]);        // Accept weight of edge
-            }
-            else
-                mat[i][j] = INT_MAX;
+    while ((opt = getopt(argc, argv, "e:t:k:b:B:d:v:r:asSm:c:p")) != -1) { // Accept options
+        switch (opt) {
+            case 'e':                                           // Exact solver
+                if (getEngineByName(optarg) == -1) {
+                    fprintf(stderr, "Unknown engine '%s'\n", optarg);
+                    return 1;
+                }
+                options.engine = (Engine) getEngineByName(optarg);
+                break;
+            case 't':                                           // Worker threads
+                options.threadCount = atoi(optarg);
+                break;
+            case 'b':                                           // Time budget of approximate engine
+                options.budgetMs = atoi(optarg);
+                break;
+            case 'B':                                           // Lower bound of branch and bound
+                if (strcmp(optarg, "auto") == 0)
+                    options.bound = NULL;
+                else if ((options.bound = getBoundByName(optarg)) == NULL) {
+                    fprintf(stderr, "Unknown bound '%s'\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'd':                                           // Deadline of search
+                options.deadlineMs = atoi(optarg);
+                break;
+            case 'v':                                           // Progress lines
+                options.progressMs = atoi(optarg);
+                break;
+            case 'r':                                           // Seed of random kicks
+                options.seed = (unsigned) strtoul(optarg, NULL, 10);
+                break;
+            case 'a':                                           // Anytime - print improved routes
+                options.anytime = 1;
+                break;
+            case 's':                                           // Statistics
+                options.stats = 1;
+                break;
+            case 'k':                                           // Matrix reduction kernels
+                kernelName = optarg;
+                break;
+            case 'm':                                           // Load binary matrix file instead of text input
+                matrixPath = optarg;
+                break;
+            case 'c':                                           // Convert text input to binary matrix file
+                convertPath = optarg;
+                break;
+            case 'p':                                           // Coordinates instead of matrix
+                points = 1;
+                break;
+            case 'S':                                           // Batch of instances
+                batchMode = 1;
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-e auto|bnb|heldkarp|approx] [-B auto|reduce|onetree] [-b ms] [-r seed] [-d ms] [-v ms] [-a] [-s] [-t threads] [-k auto|avx2|sse4.1|scalar] [-p] [-S | -m matrix | -c matrix]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    if (!selectKernels(kernelName)) {
+        fprintf(stderr, "Kernels '%s' unknown or not supported by this CPU\n", kernelName);
+        return 1;
+    }
+
+    memset(&stop, 0, sizeof(stop));
+    stop.sa_handler = requestStop;
+    stop.sa_flags = SA_RESETHAND;               // A second signal kills the process outright
+    sigaction(SIGINT, &stop, NULL);
+    sigaction(SIGTERM, &stop, NULL);
+
+    if (batchMode) {                            // Many instances, each solved single threaded
+        if (matrixPath != NULL || convertPath != NULL || options.anytime || options.progressMs > 0) {
+            fprintf(stderr, "Batch mode takes text input only, without -a or -v\n");
+            return 1;
         }
+        return solveBatch(points, options.threadCount) ? 0 : 1;
+    }
+
+    initSolver(&solver, options.threadCount);
+    resetStats(&solver.stats);                  // Deadline counts from here, input included
+
+    instance = (matrixPath != NULL) ? loadMatrixFile(matrixPath) : readInstance(points);    // Set up instance
+    if (instance == NULL) {
+        destroySolver(&solver);
+        return 1;
+    }
+
+    if (convertPath != NULL) {                  // Only convert text input to matrix file
+        int written = writeMatrixFile(instance, convertPath);
+        destroyInstance(instance);
+        destroySolver(&solver);
+        return written ? 0 : 1;
     }
 
-    scanf("%d", &src);                          // Accept source vertex
+    n = instance->n;
+    src = instance->src;
 
-    minRouteDist = TSP(mat, path, n, --src);    // Derive minimum route distance
+    if (options.engine == ENGINE_HELD_KARP && n > HELD_KARP_LIMIT) {
+        fprintf(stderr, "Held-Karp is limited to %d vertices\n", HELD_KARP_LIMIT);
+        destroyInstance(instance);
+        destroySolver(&solver);
+        return 1;
+    }
 
-    printf("\n%d\n\n", minRouteDist);
+    path = (int *) malloc(n * sizeof(int));
+    minRouteDist = TSP(&solver, instance, path, src);   // Derive minimum route distance
+    printResult(&solver, path, n, src, minRouteDist);
 
-    viewPath(path, n, src);                     // View route
+    free(path);
+    destroyInstance(instance);
+    destroySolver(&solver);
 
     return 0;
 }
 
+/*
+ * USAGE
+ *
+ * gcc -O2 -pthread prog.c -o prog -lm
+ * prog [-e auto|bnb|heldkarp|approx] [-B auto|reduce|onetree] [-b ms] [-r seed] [-t threads] [-k auto|avx2|sse4.1|scalar] [-p] < input
+ * prog [-e ...] [-B ...] [-b ms] [-r seed] [-t threads] [-k ...] -m matrix
+ * prog [-p] -c matrix < input
+ * prog -S [-e ...] [-B ...] [-b ms] [-r seed] [-d ms] [-s] [-t threads] [-k ...] [-p] < instances
+ *
+ *  -e  Exact solver (default auto)
+ *          auto     - heldkarp up to 20 vertices, bnb beyond
+ *          bnb      - Best first branch and bound (lower bound as per -B)
+ *          heldkarp - Dynamic programming over subsets, O(n^2 * 2^n) whatever the weights (at most 24 vertices)
+ *          approx   - Nearest neighbour route improved by 2-opt and Or-opt, kicked and improved again till
+ *                     time budget runs out - near optimal, not necessarily optimal (exact up to 9 vertices)
+ *      bnb starts off a single nearest neighbour + local search route, so it can prune from the first node
+ *  -B  Lower bound of bnb (default auto - onetree if matrix is symmetric, reduce otherwise)
+ *          reduce   - Cost of reduced matrix, child matrices reduced incrementally from parent's
+ *          onetree  - Held-Karp 1-tree bound, vertex penalties tuned by subgradient steps and handed down
+ *                     to children. Built over min(c[i][j], c[j][i]), so valid on asymmetric matrices too,
+ *                     though weak there
+ *  -b  Time budget of approx engine, milliseconds (default 100)
+ *  -r  Seed of random kicks of approx engine (default 2463534242) - same input, seed and budget
+ *      give the same route unless the budget runs out at a different kick. Mixed with the no. of
+ *      instance in batch mode
+ *  -d  Deadline, milliseconds since start (input included) - bnb stops and prints best route found so far
+ *      (noted on stderr as not proven optimal), approx stops improving. SIGINT / SIGTERM stop the same way
+ *      (a second one kills outright). heldkarp always runs to the end
+ *  -v  Progress line on stderr every so many milliseconds (bnb) - expanded, live and pruned nodes,
+ *      best route, least bound of live nodes and gap between the two
+ *  -a  Anytime - print every improved route as soon as it is found, "~ cost seconds route"
+ *  -s  Statistics of run on stderr as a JSON object - engine, bound, nodes expanded, generated and
+ *      pruned, complete routes tried, time spent in bounds, best route, lower bound, gap, stopped
+ *  -t  No. of worker threads (default - online cores)
+ *      Minimum route distance is always the optimum, though with several optimal
+ *      routes, which one is shown may differ from run to run when more than one thread is used
+ *  -k  Kernels of matrix reduction (default auto - best one supported by CPU)
+ *  -p  Input holds coordinates of vertices instead of a matrix (see INPUT FORMAT),
+ *      weight of every edge is Euclidean distance rounded to nearest integer.
+ *      approx works straight over coordinates, exact engines build the full matrix
+ *  -c  Convert text input to binary matrix file and exit -
+ *      "TSPM", int version, int n, int source (0 based), then n * n int weights row wise (INT_MAX - no edge)
+ *  -m  Solve over binary matrix file (mapped into memory, no parsing) instead of text input
+ *  -S  Batch - input is a stream of instances, one after other (see INPUT FORMAT), solved -t at a time,
+ *      each single threaded by a worker reusing its own buffers, node pools and tables for all of its
+ *      instances. Results are printed in input order, each followed by an empty line. -d counts per
+ *      instance, from its start; on SIGINT / SIGTERM instances being solved stop as above and no more
+ *      are started. A malformed instance ends the batch (results of earlier ones are still printed)
+ *
+ */
+
 /*
  * INPUT FORMAT
  *
@@ -290,6 +3257,14 @@ int main() {
  * (vertex name) [(vertex name)...]
  * (source vertex)
  *
+ * With '-p'
+ *
+ * (amount of vertices)
+ * (x) (y)                  - one line per vertex
+ * (source vertex)
+ *
+ * With '-S', any number of the above, one after other
+ *
  */
 
 /*
@@ -298,7 +3273,7 @@ int main() {
  * (minimum route distance)
  *
  * (path){
- *      (src vertex name) => [(linking vertex name)...] => (destination vertex name)
+ *      (src vertex name) => [(linking vertex name)...] => (src vertex name)
  * }
  *
  */
@@ -318,6 +3293,6 @@ int main() {
 
 28
 
-1 => 4 => 2 => 5 => 3
+1 => 4 => 2 => 5 => 3 => 1
 
  */